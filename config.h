@@ -17,6 +17,10 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+namespace vkUtil {
+	class MemoryAllocator;
+}
+
 /**
 	Data structures used for creating buffers
 	and allocating memory
@@ -27,6 +31,20 @@ struct BufferInputChunk {
 	vk::Device logicalDevice;
 	vk::PhysicalDevice physicalDevice;
 	vk::MemoryPropertyFlags memoryProperties;
+	vkUtil::MemoryAllocator* allocator;
+};
+
+/**
+	a range of a device memory block, handed out by the memory allocator
+*/
+struct MemoryAllocation {
+	vk::DeviceMemory memory;
+	vk::DeviceSize offset;
+	vk::DeviceSize size;
+	uint32_t memoryTypeIndex;
+	bool linear;
+	//start of the range if the memory type is host visible, otherwise nullptr
+	void* mappedData;
 };
 
 /**
@@ -34,12 +52,5 @@ struct BufferInputChunk {
 */
 struct Buffer {
 	vk::Buffer buffer;
-	vk::DeviceMemory bufferMemory;
+	MemoryAllocation bufferMemory;
 };
-
-//--------- Assets -------------//
-enum class meshTypes {
-	TRIANGLE,
-	SQUARE,
-	STAR
-};
\ No newline at end of file
@@ -14,9 +14,11 @@ App::App(int width, int height, bool debug) {
 
 	build_glfw_window(width, height);
 
-	graphicsEngine = new Engine(width, height, window);
+	registry = new AssetRegistry();
 
-	scene = new Scene();
+	graphicsEngine = new Engine(width, height, window, registry);
+
+	scene = new Scene(registry);
 }
 
 /**
@@ -87,4 +89,5 @@ void App::calculateFrameRate() {
 App::~App() {
 	delete graphicsEngine;
 	delete scene;
+	delete registry;
 }
\ No newline at end of file
@@ -8,6 +8,7 @@ class App {
 private:
 	Engine* graphicsEngine;
 	GLFWwindow* window;
+	AssetRegistry* registry;
 	Scene* scene;
 
 	double lastTime, currentTime;
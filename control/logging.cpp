@@ -1,9 +1,15 @@
 #include "logging.h"
+#include <mutex>
 
 namespace vkLogging {
 	Logger* Logger::logger;
 }
 
+namespace {
+	//worker threads log too, this keeps their lines from interleaving
+	std::mutex outputLock;
+}
+
 void vkLogging::Logger::set_debug_mode(bool mode) {
 	debugMode = mode;
 }
@@ -26,11 +32,13 @@ void vkLogging::Logger::print(std::string message) {
 		return;
 	}
 
+	std::lock_guard<std::mutex> lock(outputLock);
 	std::cout << message << std::endl;
 }
 
 void vkLogging::Logger::print_list(std::vector<std::string> items) {
 
+	std::lock_guard<std::mutex> lock(outputLock);
 	for (std::string item : items) {
 		std::cout << "\t\t" << item << std::endl;
 	}
@@ -409,6 +417,7 @@ VKAPI_ATTR VkBool32 VKAPI_CALL vkLogging::debugCallback(
 
 	*/
 
+	std::lock_guard<std::mutex> lock(outputLock);
 	std::cerr << "validation layer: " << pCallbackData->pMessage << std::endl;
 
 	return VK_FALSE;
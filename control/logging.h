@@ -10,6 +10,7 @@ namespace vkLogging {
 		void set_debug_mode(bool mode);
 		bool get_debug_mode();
 		//void log_device_properties(vk::PhysicalDevice physical_device);
+		//print and print_list may be called from any thread, the first get_logger call must come from the main thread
 		void print(std::string message);
 		void print_list(std::vector<std::string> items);
 		//void log_device_properties(vk::PhysicalDevice device);
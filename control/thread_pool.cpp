@@ -0,0 +1,105 @@
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(size_t workerCount) {
+
+	task = nullptr;
+	taskCount = 0;
+	nextTask = 0;
+	remainingTasks = 0;
+	generation = 0;
+	busyWorkers = 0;
+	stopping = false;
+
+	for (size_t i = 0; i < workerCount; ++i) {
+		workers.emplace_back(&ThreadPool::work, this);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
+
+void ThreadPool::parallel_for(size_t taskCount, const std::function<void(size_t)>& task) {
+
+	if (taskCount == 0) {
+		return;
+	}
+
+	//not worth waking anyone for
+	if (taskCount == 1 || workers.empty()) {
+		for (size_t i = 0; i < taskCount; ++i) {
+			task(i);
+		}
+		return;
+	}
+
+	{
+		//a worker which woke up too late for the last loop may still be on its way out
+		std::unique_lock<std::mutex> lock(mutex);
+		finished.wait(lock, [this]() { return busyWorkers == 0; });
+		this->task = &task;
+		this->taskCount = taskCount;
+		nextTask = 0;
+		remainingTasks = taskCount;
+		++generation;
+	}
+	wake.notify_all();
+
+	run_tasks();
+
+	//workers may still be reading task, so wait for them to leave as well
+	std::unique_lock<std::mutex> lock(mutex);
+	finished.wait(lock, [this]() { return remainingTasks == 0 && busyWorkers == 0; });
+	this->task = nullptr;
+}
+
+size_t ThreadPool::thread_count() const {
+	return workers.size() + 1;
+}
+
+void ThreadPool::work() {
+
+	uint64_t seenGeneration = 0;
+
+	while (true) {
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [&]() { return stopping || generation != seenGeneration; });
+			if (stopping) {
+				return;
+			}
+			seenGeneration = generation;
+			++busyWorkers;
+		}
+
+		run_tasks();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			--busyWorkers;
+		}
+		finished.notify_all();
+	}
+}
+
+void ThreadPool::run_tasks() {
+
+	size_t i;
+	while ((i = nextTask.fetch_add(1)) < taskCount) {
+		(*task)(i);
+		if (remainingTasks.fetch_sub(1) == 1) {
+			std::lock_guard<std::mutex> lock(mutex);
+			finished.notify_all();
+		}
+	}
+}
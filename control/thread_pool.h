@@ -0,0 +1,54 @@
+#pragma once
+#include "../config.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+/**
+	A fixed set of worker threads for splitting a loop into tasks.
+	The calling thread works on the tasks too.
+*/
+class ThreadPool {
+
+public:
+	/**
+		\param workerCount how many threads to start besides the caller's
+	*/
+	ThreadPool(size_t workerCount);
+
+	~ThreadPool();
+
+	/**
+		Run task(i) for every i in [0, taskCount), returning once all have finished.
+
+		\param taskCount the number of tasks
+		\param task the work to do, called concurrently from several threads
+	*/
+	void parallel_for(size_t taskCount, const std::function<void(size_t)>& task);
+
+	/**
+		\returns how many threads work on a parallel_for, including the caller's
+	*/
+	size_t thread_count() const;
+
+private:
+
+	std::vector<std::thread> workers;
+
+	std::mutex mutex;
+	std::condition_variable wake, finished;
+
+	//the current parallel_for, workers join it when the generation changes
+	const std::function<void(size_t)>* task;
+	size_t taskCount;
+	std::atomic<size_t> nextTask;
+	std::atomic<size_t> remainingTasks;
+	uint64_t generation;
+	size_t busyWorkers;
+	bool stopping;
+
+	void work();
+	void run_tasks();
+};
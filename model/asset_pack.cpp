@@ -0,0 +1,109 @@
+#include "asset_pack.h"
+#include "../view/vkImage/blocks.h"
+#include "../view/vkImage/mipmaps.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+	//whether a range lies within a file of the given size, without overflowing
+	bool in_file(uint64_t offset, uint64_t size, uint64_t fileSize) {
+		return size <= fileSize && offset <= fileSize - size;
+	}
+
+	/*
+	* Checked like a KTX2 header: a format textures can be loaded in, a size,
+	* 1 to a full chain of levels, and exactly the bytes those levels take.
+	*/
+	bool valid_texture(const PackTexture& texture) {
+
+		vk::Format format = static_cast<vk::Format>(texture.format);
+		bool knownFormat = vkImage::is_block_compressed(format)
+			|| format == vk::Format::eR8G8B8A8Unorm || format == vk::Format::eR8G8B8A8Srgb;
+		uint32_t maxSize = static_cast<uint32_t>(std::numeric_limits<int>::max());
+		if (!knownFormat || texture.width == 0 || texture.height == 0
+			|| texture.width > maxSize || texture.height > maxSize) {
+			return false;
+		}
+
+		int width = static_cast<int>(texture.width);
+		int height = static_cast<int>(texture.height);
+		if (texture.mipLevels == 0 || texture.mipLevels > vkImage::mip_level_count(width, height)) {
+			return false;
+		}
+
+		uint64_t size = 0;
+		for (uint32_t level = 0; level < texture.mipLevels; ++level) {
+			size += vkImage::level_size(format, std::max(width >> level, 1), std::max(height >> level, 1));
+		}
+		return texture.size == size;
+	}
+}
+
+bool AssetPack::open(const std::string& filename) {
+
+	std::ifstream file(filename, std::ios::binary | std::ios::ate);
+	uint64_t fileSize = file ? static_cast<uint64_t>(file.tellg()) : 0;
+	file.seekg(0);
+	PackHeader header;
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))
+		|| header.magic != packMagic || header.version != packVersion) {
+		return false;
+	}
+
+	//the tables must fit in the file before anything is allocated for them
+	uint64_t tableSize = sizeof(PackTexture) * static_cast<uint64_t>(header.textureCount)
+		+ sizeof(PackMesh) * static_cast<uint64_t>(header.meshCount);
+	if (!in_file(sizeof(header), tableSize, fileSize)) {
+		return false;
+	}
+
+	textures.resize(header.textureCount);
+	meshes.resize(header.meshCount);
+	if (!file.read(reinterpret_cast<char*>(textures.data()), sizeof(PackTexture) * textures.size())
+		|| !file.read(reinterpret_cast<char*>(meshes.data()), sizeof(PackMesh) * meshes.size())) {
+		textures.clear();
+		meshes.clear();
+		return false;
+	}
+
+	//names are zero padded, make sure they end, and everything an entry points to must be in the file
+	bool valid = true;
+	for (PackTexture& texture : textures) {
+		texture.name[packNameLength - 1] = '\0';
+		valid = valid && valid_texture(texture) && in_file(texture.offset, texture.size, fileSize);
+	}
+	for (PackMesh& mesh : meshes) {
+		mesh.name[packNameLength - 1] = '\0';
+		valid = valid && in_file(mesh.vertexOffset, sizeof(PackedVertex) * static_cast<uint64_t>(mesh.vertexCount), fileSize)
+			&& in_file(mesh.indexOffset, sizeof(uint32_t) * static_cast<uint64_t>(mesh.indexCount), fileSize);
+	}
+	if (!valid) {
+		textures.clear();
+		meshes.clear();
+		return false;
+	}
+
+	this->filename = filename;
+	return true;
+}
+
+bool AssetPack::read(uint64_t offset, uint64_t size, void* destination) const {
+
+	std::ifstream file(filename, std::ios::binary);
+	file.seekg(static_cast<std::streamoff>(offset));
+	return static_cast<bool>(file.read(static_cast<char*>(destination), static_cast<std::streamsize>(size)));
+}
+
+bool AssetPack::read_mesh(const PackMesh& mesh, std::vector<PackedVertex>& vertices, std::vector<uint32_t>& indices) const {
+
+	vertices.resize(mesh.vertexCount);
+	indices.resize(mesh.indexCount);
+	if (!read(mesh.vertexOffset, sizeof(PackedVertex) * vertices.size(), vertices.data())
+		|| !read(mesh.indexOffset, sizeof(uint32_t) * indices.size(), indices.data())) {
+		return false;
+	}
+
+	//indices count from the mesh's first vertex, and mustn't reach past its last
+	return std::none_of(indices.begin(), indices.end(), [&](uint32_t index) { return index >= mesh.vertexCount; });
+}
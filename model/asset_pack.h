@@ -0,0 +1,89 @@
+#pragma once
+#include "../config.h"
+#include "packed_vertex.h"
+
+//"PACK", read as a little endian uint32_t
+constexpr uint32_t packMagic = 0x4B434150;
+constexpr uint32_t packVersion = 1;
+constexpr uint32_t packNameLength = 32;
+
+/**
+	The start of an asset pack. The texture table follows it, then the
+	mesh table, then the data they point to. Every field is little endian.
+*/
+struct PackHeader {
+	uint32_t magic, version;
+	uint32_t textureCount, meshCount;
+};
+
+/**
+	A texture in an asset pack. Its levels are tightly packed from
+	offset, largest first, already in the format the GPU samples.
+*/
+struct PackTexture {
+	char name[packNameLength];
+	//a VkFormat, RGBA8 or block compressed
+	uint32_t format;
+	uint32_t width, height, mipLevels;
+	uint64_t offset, size;
+};
+
+/**
+	A mesh in an asset pack: PackedVertex vertices, and uint32_t indices
+	counted from the mesh's first vertex.
+*/
+struct PackMesh {
+	char name[packNameLength];
+	uint32_t vertexCount, indexCount;
+	//distance from the origin to the furthest vertex
+	float radius;
+	uint32_t padding;
+	uint64_t vertexOffset, indexOffset;
+};
+
+static_assert(sizeof(PackHeader) == 16 && sizeof(PackTexture) == 64 && sizeof(PackMesh) == 64,
+	"pack tables must match the file layout");
+
+/**
+	An asset pack made by the cooker, opened for reading. The tables are
+	read when it's opened, and the data as it's asked for.
+*/
+class AssetPack {
+public:
+
+	/**
+		Open a pack and read its tables.
+
+		\param filename the path to the pack
+		\returns whether the file exists, is a pack of this version, its tables
+			only point inside it and every texture's levels add up to its size
+	*/
+	bool open(const std::string& filename);
+
+	/**
+		Read a range of the pack. Each call opens its own stream,
+		so several threads can read at once.
+
+		\param offset where the range starts, from the start of the file
+		\param size the size (in bytes) of the range
+		\param destination where to copy the range
+		\returns whether the whole range could be read
+	*/
+	bool read(uint64_t offset, uint64_t size, void* destination) const;
+
+	/**
+		Read a mesh's vertices and indices, checking that no index reaches past its vertices.
+
+		\param mesh the mesh's entry in the pack
+		\param vertices filled with the mesh's vertices
+		\param indices filled with the mesh's indices
+		\returns whether the mesh could be read and its indices are in range
+	*/
+	bool read_mesh(const PackMesh& mesh, std::vector<PackedVertex>& vertices, std::vector<uint32_t>& indices) const;
+
+	std::vector<PackTexture> textures;
+	std::vector<PackMesh> meshes;
+
+private:
+	std::string filename;
+};
@@ -0,0 +1,62 @@
+#include "builtin_assets.h"
+
+std::vector<MeshSource> builtin_meshes() {
+
+	std::vector<MeshSource> meshes(3);
+
+	meshes[0].name = "triangle";
+	meshes[0].vertices = { {
+		 0.0f, -0.1f, 0.0f, 1.0f, 0.0f, 0.5f, 0.0f, //0
+		 0.1f, 0.1f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f,  // 1
+		-0.1f, 0.1f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f   // 2
+	} };
+	meshes[0].indices = { {
+			0, 1, 2
+	} };
+
+	meshes[1].name = "square";
+	meshes[1].vertices = { {
+		-0.1f,  0.1f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f,	// 0
+		-0.1f, -0.1f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f,	// 1
+		 0.1f, -0.1f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f,	// 2
+		 0.1f,  0.1f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f,	// 3
+	} };
+	meshes[1].indices = { {
+			0, 1, 2, 
+			2, 3, 0
+	} };
+
+	meshes[2].name = "star";
+	meshes[2].vertices = { {
+		-0.1f, -0.05f, 1.0f, 1.0f, 1.0f, 0.0f, 0.25f, //0
+		-0.04f, -0.05f, 1.0f, 1.0f, 1.0f, 0.3f, 0.25f, //1
+		-0.06f,   0.0f, 1.0f, 1.0f, 1.0f, 0.2f,  0.5f, //2
+		  0.0f,  -0.1f, 1.0f, 1.0f, 1.0f, 0.5f,  0.0f, //3
+		 0.04f, -0.05f, 1.0f, 1.0f, 1.0f, 0.7f, 0.25f, //4
+		  0.1f, -0.05f, 1.0f, 1.0f, 1.0f, 1.0f, 0.25f, //5
+		 0.06f,   0.0f, 1.0f, 1.0f, 1.0f, 0.8f,  0.5f, //6
+		 0.08f,   0.1f, 1.0f, 1.0f, 1.0f, 0.9f,  1.0f, //7
+		  0.0f,  0.02f, 1.0f, 1.0f, 1.0f, 0.5f,  0.6f, //8
+		-0.08f,   0.1f, 1.0f, 1.0f, 1.0f, 0.1f,  1.0f  //9
+	} };
+	meshes[2].indices = { {
+			0, 1, 2,
+			1, 3, 4,
+			2, 1, 4,
+			4, 5, 6,
+			2, 4, 6,
+			6, 7, 8,
+			2, 6, 8,
+			2, 8, 9,
+	} };
+
+	return meshes;
+}
+
+std::vector<MaterialSource> builtin_materials() {
+	return {
+		{"brick_wall", "tex/brick_wall.jpg"},
+		{"wood", "tex/wood_texture.jpg"},
+		{"ground", "tex/ground_texture.jpg"}
+	};
+}
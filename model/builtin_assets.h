@@ -0,0 +1,30 @@
+#pragma once
+#include "../config.h"
+
+/**
+	A mesh as it's authored, seven floats per vertex: x y r g b u v.
+*/
+struct MeshSource {
+	std::string name;
+	std::vector<float> vertices;
+	std::vector<uint32_t> indices;
+};
+
+/**
+	A material and the image file it's made from.
+*/
+struct MaterialSource {
+	std::string name;
+	std::string filename;
+};
+
+/**
+	\returns the meshes the engine comes with, loaded as they are
+		when there's no asset pack and cooked into one by the cooker
+*/
+std::vector<MeshSource> builtin_meshes();
+
+/**
+	\returns the materials the engine comes with, paths are relative to the working directory
+*/
+std::vector<MaterialSource> builtin_materials();
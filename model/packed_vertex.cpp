@@ -0,0 +1,68 @@
+#include "packed_vertex.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+	uint16_t to_unorm16(float value) {
+		return static_cast<uint16_t>(std::clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+	}
+
+	uint8_t to_unorm8(float value) {
+		return static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+	}
+}
+
+PackedVertex pack_vertex(const float* vertex) {
+
+	PackedVertex packed;
+	packed.position[0] = to_half(vertex[0]);
+	packed.position[1] = to_half(vertex[1]);
+	packed.color[0] = to_unorm8(vertex[2]);
+	packed.color[1] = to_unorm8(vertex[3]);
+	packed.color[2] = to_unorm8(vertex[4]);
+	packed.color[3] = 255;
+	packed.texCoord[0] = to_unorm16(vertex[5]);
+	packed.texCoord[1] = to_unorm16(vertex[6]);
+	return packed;
+}
+
+uint16_t to_half(float value) {
+
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	uint32_t sign = (bits >> 16) & 0x8000;
+	uint32_t floatExponent = (bits >> 23) & 0xff;
+	uint32_t mantissa = bits & 0x7fffff;
+
+	//infinity and NaN
+	if (floatExponent == 0xff) {
+		return static_cast<uint16_t>(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+	}
+
+	int32_t exponent = static_cast<int32_t>(floatExponent) - 127 + 15;
+	if (exponent >= 31) {
+		return static_cast<uint16_t>(sign | 0x7c00);
+	}
+
+	//too small for a normal half, the implicit bit becomes part of a subnormal mantissa
+	uint32_t shift = 13;
+	uint32_t half = static_cast<uint32_t>(exponent) << 10;
+	if (exponent <= 0) {
+		if (exponent < -10) {
+			return static_cast<uint16_t>(sign);
+		}
+		mantissa |= 0x800000;
+		shift = static_cast<uint32_t>(14 - exponent);
+		half = 0;
+	}
+
+	//round to nearest even, a carry out of the mantissa correctly bumps the exponent
+	half |= mantissa >> shift;
+	uint32_t rest = mantissa & ((1u << shift) - 1);
+	uint32_t halfway = 1u << (shift - 1);
+	if (rest > halfway || (rest == halfway && (half & 1))) {
+		++half;
+	}
+	return static_cast<uint16_t>(sign | half);
+}
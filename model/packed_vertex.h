@@ -0,0 +1,31 @@
+#pragma once
+#include "../config.h"
+
+/**
+	The vertex format meshes are kept in on the GPU, 12 bytes a vertex
+	instead of 28. The vertex shader still reads floats, the vertex
+	input formats widen each attribute.
+*/
+struct PackedVertex {
+	//half floats
+	uint16_t position[2];
+	//unorm, the fourth byte is padding
+	uint8_t color[4];
+	//unorm, so texture coordinates are limited to [0, 1]
+	uint16_t texCoord[2];
+};
+static_assert(sizeof(PackedVertex) == 12, "PackedVertex must match the vertex input description");
+
+/**
+	Quantize one vertex as meshes are authored.
+
+	\param vertex seven floats: x y r g b u v
+	\returns the packed vertex
+*/
+PackedVertex pack_vertex(const float* vertex);
+
+/**
+	\param value a float
+	\returns the nearest half float, as its bits
+*/
+uint16_t to_half(float value);
@@ -0,0 +1,45 @@
+#include "registry.h"
+
+uint32_t AssetRegistry::register_mesh(const std::string& name) {
+	return register_name(name, meshNames, meshHandles);
+}
+
+uint32_t AssetRegistry::register_material(const std::string& name) {
+	return register_name(name, materialNames, materialHandles);
+}
+
+uint32_t AssetRegistry::find_mesh(const std::string& name) const {
+	return find_name(name, meshHandles);
+}
+
+uint32_t AssetRegistry::find_material(const std::string& name) const {
+	return find_name(name, materialHandles);
+}
+
+size_t AssetRegistry::mesh_count() const {
+	return meshNames.size();
+}
+
+size_t AssetRegistry::material_count() const {
+	return materialNames.size();
+}
+
+uint32_t AssetRegistry::register_name(const std::string& name,
+	std::vector<std::string>& names, std::unordered_map<std::string, uint32_t>& handles) {
+
+	auto existing = handles.find(name);
+	if (existing != handles.end()) {
+		return existing->second;
+	}
+
+	uint32_t handle = static_cast<uint32_t>(names.size());
+	names.push_back(name);
+	handles[name] = handle;
+	return handle;
+}
+
+uint32_t AssetRegistry::find_name(const std::string& name, const std::unordered_map<std::string, uint32_t>& handles) {
+
+	auto existing = handles.find(name);
+	return existing == handles.end() ? invalidHandle : existing->second;
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "../config.h"
+
+/**
+	Hands out dense integer handles for meshes and materials as they're
+	loaded, so per-draw data can live in flat arrays indexed by handle.
+	Names are only looked up at load time.
+*/
+class AssetRegistry {
+public:
+
+	static constexpr uint32_t invalidHandle = UINT32_MAX;
+
+	/**
+		Register a mesh, registering the same name twice returns the same handle.
+
+		\param name a unique name for the mesh
+		\returns the mesh's handle, handles count up from 0
+	*/
+	uint32_t register_mesh(const std::string& name);
+
+	/**
+		Register a material, registering the same name twice returns the same handle.
+
+		\param name a unique name for the material
+		\returns the material's handle, handles count up from 0
+	*/
+	uint32_t register_material(const std::string& name);
+
+	/**
+		\param name the name the mesh was registered with
+		\returns the mesh's handle, or invalidHandle if there's no such mesh
+	*/
+	uint32_t find_mesh(const std::string& name) const;
+
+	/**
+		\param name the name the material was registered with
+		\returns the material's handle, or invalidHandle if there's no such material
+	*/
+	uint32_t find_material(const std::string& name) const;
+
+	/**
+		\returns the number of registered meshes
+	*/
+	size_t mesh_count() const;
+
+	/**
+		\returns the number of registered materials
+	*/
+	size_t material_count() const;
+
+private:
+
+	std::vector<std::string> meshNames, materialNames;
+	std::unordered_map<std::string, uint32_t> meshHandles, materialHandles;
+
+	static uint32_t register_name(const std::string& name,
+		std::vector<std::string>& names, std::unordered_map<std::string, uint32_t>& handles);
+	static uint32_t find_name(const std::string& name, const std::unordered_map<std::string, uint32_t>& handles);
+};
@@ -1,36 +1,143 @@
 #include "scene.h"
+#include "../control/logging.h"
+#include <algorithm>
 
 /**
 * Scene constructor
 */
-Scene::Scene() {
+Scene::Scene(const AssetRegistry* registry) {
+
+	version = 0;
+	logStart = 0;
+
+	const std::pair<const char*, const char*> looks[] = {
+		{ "triangle", "brick_wall" },
+		{ "square", "wood" },
+		{ "star", "ground" }
+	};
 
 	float x = 0.3f;
-	for (float z = -1.0f; z <= 1.0f; z += 0.2) {
-		for (float y = -1.0f; y < 1.0f; y += 0.2f) {
+	for (const auto& [mesh, material] : looks) {
 
-			trianglePositions.push_back(glm::vec3(x, y, z));
+		std::vector<glm::vec3> positions;
+		for (float z = -1.0f; z <= 1.0f; z += 0.2) {
+			for (float y = -1.0f; y < 1.0f; y += 0.2f) {
 
+				positions.push_back(glm::vec3(x, y, z));
+
+			}
+		}
+		if (!add_group(registry->find_mesh(mesh), registry->find_material(material), positions)) {
+			vkLogging::Logger::get_logger()->print_list({ std::string("Skipping the ") + mesh + " instances, " + mesh + " or " + material + " isn't loaded" });
 		}
+
+		x -= 0.3f;
 	}
-	
+};
+
+/**
+* Add a run of instances
+*/
+bool Scene::add_group(uint32_t mesh, uint32_t material, const std::vector<glm::vec3>& positions) {
 
-	x = 0.0f;
-	for (float z = -1.0f; z <= 1.0f; z += 0.2) {
-		for (float y = -1.0f; y < 1.0f; y += 0.2f) {
+	//handles index the renderer's mesh and material arrays
+	if (mesh == AssetRegistry::invalidHandle || material == AssetRegistry::invalidHandle) {
+		return false;
+	}
 
-			squarePositions.push_back(glm::vec3(x, y, z));
+	InstanceGroup group;
+	group.mesh = mesh;
+	group.material = material;
+	group.first = static_cast<uint32_t>(transforms.size());
+	group.count = static_cast<uint32_t>(positions.size());
+	groups.push_back(group);
 
-		}
+	for (glm::vec3 position : positions) {
+		transforms.push_back(position);
 	}
+	return true;
+}
+
+/**
+* Move an instance and log the edit
+*/
+void Scene::set_position(uint32_t instance, glm::vec3 position) {
+
+	transforms.x[instance] = position.x;
+	transforms.y[instance] = position.y;
+	transforms.z[instance] = position.z;
+	log_edit(instance);
+}
+
+/**
+* Rotate an instance and log the edit
+*/
+void Scene::set_rotation(uint32_t instance, glm::vec4 rotation) {
+
+	transforms.qx[instance] = rotation.x;
+	transforms.qy[instance] = rotation.y;
+	transforms.qz[instance] = rotation.z;
+	transforms.qw[instance] = rotation.w;
+	log_edit(instance);
+}
+
+/**
+* Scale an instance and log the edit
+*/
+void Scene::set_scale(uint32_t instance, float scale) {
+
+	transforms.scale[instance] = scale;
+	log_edit(instance);
+}
 
-	x = -0.3f;
-	for (float z = -1.0f; z <= 1.0f; z += 0.2) {
-		for (float y = -1.0f; y < 1.0f; y += 0.2f) {
+void Scene::log_edit(uint32_t instance) {
 
-			starPositions.push_back(glm::vec3(x, y, z));
+	++version;
 
+	//extend the latest edit when it's touching, so a sweep over many instances stays one entry
+	if (!edits.empty()) {
+		TransformEdit& last = edits.back();
+		if (instance >= last.first && instance <= last.first + last.count) {
+			last.count = std::max(last.count, instance - last.first + 1);
+			last.version = version;
+			return;
 		}
 	}
 
-};
\ No newline at end of file
+	//past this point uploading everything is cheaper than walking the log
+	if (edits.size() >= transforms.size() / 4) {
+		edits.clear();
+		logStart = version;
+		return;
+	}
+
+	edits.push_back({ instance, 1, version });
+}
+
+/**
+* Drop the edits every consumer has seen
+*/
+void Scene::trim_edits(uint64_t syncedVersion) {
+
+	auto firstUnseen = std::find_if(edits.begin(), edits.end(),
+		[&](const TransformEdit& edit) { return edit.version > syncedVersion; });
+	edits.erase(edits.begin(), firstUnseen);
+
+	logStart = std::max(logStart, std::min(syncedVersion, version));
+}
+
+void TransformStorage::push_back(glm::vec3 position) {
+
+	x.push_back(position.x);
+	y.push_back(position.y);
+	z.push_back(position.z);
+	qx.push_back(0.0f);
+	qy.push_back(0.0f);
+	qz.push_back(0.0f);
+	qw.push_back(1.0f);
+	scale.push_back(1.0f);
+}
+
+size_t TransformStorage::size() const {
+	return x.size();
+}
@@ -1,14 +1,110 @@
 #pragma once
 #include "../config.h"
+#include "registry.h"
+
+/**
+	A range of instances whose transforms changed, stamped
+	with the scene version the change was made at.
+*/
+struct TransformEdit {
+	uint32_t first;
+	uint32_t count;
+	uint64_t version;
+};
+
+/**
+	Instance transforms as structure of arrays, one array per
+	component, so they can be processed several at a time.
+*/
+struct TransformStorage {
+	std::vector<float> x, y, z;
+	std::vector<float> qx, qy, qz, qw;
+	std::vector<float> scale;
+
+	/**
+		Add an instance with no rotation and unit scale.
+
+		\param position the position of the instance
+	*/
+	void push_back(glm::vec3 position);
+
+	/**
+		\returns the number of instances
+	*/
+	size_t size() const;
+};
+
+/**
+	A run of instances sharing a mesh and a material,
+	stored contiguously in the scene's transforms.
+*/
+struct InstanceGroup {
+	uint32_t mesh;
+	uint32_t material;
+	uint32_t first;
+	uint32_t count;
+};
 
 class Scene {
 
 public:
-	Scene();
+	/**
+		\param registry the registry the scene's meshes and materials were loaded into
+	*/
+	Scene(const AssetRegistry* registry);
+
+	/**
+		Add a group of instances, with no rotation and unit scale.
+
+		\param mesh the handle of the mesh to draw
+		\param material the handle of the material to draw it with
+		\param positions the position of each instance
+		\returns whether the group was added, it isn't if either handle is invalid
+	*/
+	bool add_group(uint32_t mesh, uint32_t material, const std::vector<glm::vec3>& positions);
+
+	/**
+		Move an instance, logging the edit so that renderers
+		only need to upload the instances which changed.
+
+		\param instance the index of the instance
+		\param position its new position
+	*/
+	void set_position(uint32_t instance, glm::vec3 position);
+
+	/**
+		Rotate an instance, logging the edit.
+
+		\param instance the index of the instance
+		\param rotation its new rotation, a unit quaternion (x, y, z, w)
+	*/
+	void set_rotation(uint32_t instance, glm::vec4 rotation);
+
+	/**
+		Scale an instance, logging the edit.
+
+		\param instance the index of the instance
+		\param scale its new (uniform) scale
+	*/
+	void set_scale(uint32_t instance, float scale);
+
+	/**
+		Forget every edit at or before a version, once all
+		consumers have caught up with it.
+
+		\param syncedVersion the oldest version any consumer is synced to
+	*/
+	void trim_edits(uint64_t syncedVersion);
+
+	//instance transforms, in group order. Edit through the setters above
+	TransformStorage transforms;
+	std::vector<InstanceGroup> groups;
 
-	std::vector<glm::vec3> trianglePositions;
+	//version of the latest edit, consumers synced to anything older than logStart must upload everything
+	uint64_t version, logStart;
+	std::vector<TransformEdit> edits;
 
-	std::vector<glm::vec3> squarePositions;
+private:
 
-	std::vector<glm::vec3> starPositions;
-};
\ No newline at end of file
+	void log_edit(uint32_t instance);
+};
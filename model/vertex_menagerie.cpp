@@ -1,92 +1,89 @@
 #include "vertex_menagerie.h"
+#include <algorithm>
 
 VertexMenagerie::VertexMenagerie() {
-	indexOffset = 0;
+	vertexOffset = 0;
 }
 	
-void VertexMenagerie::consume(meshTypes type, std::vector<float> vertexData, std::vector<uint32_t> indexData) {
+void VertexMenagerie::consume(uint32_t mesh, std::vector<float> vertexData, std::vector<uint32_t> indexData) {
 
 	
 	int vertexCount = static_cast<int>(vertexData.size() / 7); // 7 for texture coordinate
-	int indexCount = static_cast<int>(indexData.size());
-	int lastIndex = static_cast<int>(indexLump.size());
 
+	//positions are the first two attributes of each vertex
+	float radius = 0.0f;
+	std::vector<PackedVertex> packedVertices(vertexCount);
+	for (int vertex = 0; vertex < vertexCount; ++vertex) {
+		glm::vec2 position = glm::vec2(vertexData[7 * vertex], vertexData[7 * vertex + 1]);
+		radius = std::max(radius, glm::length(position));
+		packedVertices[vertex] = pack_vertex(&vertexData[7 * vertex]);
+	}
 
-	firstIndices.insert(std::make_pair(type, lastIndex));
-	indexCounts.insert(std::make_pair(type, indexCount));
+	consume_packed(mesh, packedVertices, indexData, radius);
+}
 
-	for (float attribute : vertexData) {
-		vertexLump.push_back(attribute);
-	}
+void VertexMenagerie::consume_packed(uint32_t mesh, const std::vector<PackedVertex>& vertexData, const std::vector<uint32_t>& indexData, float radius) {
 
-	for (uint32_t index : indexData) {
-		indexLump.push_back(index + indexOffset);
+	int indexCount = static_cast<int>(indexData.size());
+	int lastIndex = static_cast<int>(indexLump.size());
+
+	if (mesh >= firstIndices.size()) {
+		firstIndices.resize(mesh + 1, 0);
+		indexCounts.resize(mesh + 1, 0);
+		vertexOffsets.resize(mesh + 1, 0);
+		boundingRadii.resize(mesh + 1, 0.0f);
 	}
+	firstIndices[mesh] = lastIndex;
+	indexCounts[mesh] = indexCount;
+	vertexOffsets[mesh] = vertexOffset;
+	boundingRadii[mesh] = radius;
+
+	vertexLump.insert(vertexLump.end(), vertexData.begin(), vertexData.end());
+	indexLump.insert(indexLump.end(), indexData.begin(), indexData.end());
 
-	indexOffset += vertexCount;
+	vertexOffset += static_cast<int>(vertexData.size());
 }
 
 void VertexMenagerie::finalize(vertexBufferFinalizationChunk finalizationChunk) {
 
 	logicalDevice = finalizationChunk.logicalDevice;
+	allocator = finalizationChunk.allocator;
 
-	// staging buffer for vertices
-	BufferInputChunk inputChunk;
-	inputChunk.logicalDevice = finalizationChunk.logicalDevice;
-	inputChunk.physicalDevice = finalizationChunk.physicalDevice;
-	inputChunk.size = sizeof(float) * vertexLump.size();
-	inputChunk.usage = vk::BufferUsageFlagBits::eTransferSrc;
-	inputChunk.memoryProperties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
-	Buffer stagingBuffer = vkUtil::createBuffer(inputChunk);
+	// stage vertex and index data
+	vkUtil::StagingRegion vertexRegion = finalizationChunk.transfer->stage(sizeof(PackedVertex) * vertexLump.size());
+	memcpy(vertexRegion.data, vertexLump.data(), vertexRegion.size);
 
-	// fill it with vertex data
-	void* memoryLocation = logicalDevice.mapMemory(stagingBuffer.bufferMemory, 0, inputChunk.size);
-	memcpy(memoryLocation, vertexLump.data(), inputChunk.size);
-	logicalDevice.unmapMemory(stagingBuffer.bufferMemory);
+	vkUtil::StagingRegion indexRegion = finalizationChunk.transfer->stage(sizeof(uint32_t) * indexLump.size());
+	memcpy(indexRegion.data, indexLump.data(), indexRegion.size);
 
 	// make the vertex buffer
+	BufferInputChunk inputChunk;
+	inputChunk.logicalDevice = finalizationChunk.logicalDevice;
+	inputChunk.physicalDevice = finalizationChunk.physicalDevice;
+	inputChunk.allocator = allocator;
+	inputChunk.size = vertexRegion.size;
 	inputChunk.usage = vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eVertexBuffer;
 	inputChunk.memoryProperties = vk::MemoryPropertyFlagBits::eDeviceLocal;
 	vertexBuffer = vkUtil::createBuffer(inputChunk);
 
 	// fill it
-	vkUtil::copyBuffer(stagingBuffer, vertexBuffer, inputChunk.size, finalizationChunk.queue, finalizationChunk.commandBuffer);
-
-	// destroy statging buffer
-	logicalDevice.destroyBuffer(stagingBuffer.buffer);
-	logicalDevice.freeMemory(stagingBuffer.bufferMemory);
-
-
-	// make staging buffer for indices
-	inputChunk.size = sizeof(uint32_t) * indexLump.size();
-	inputChunk.usage = vk::BufferUsageFlagBits::eTransferSrc;
-	inputChunk.memoryProperties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
-	stagingBuffer = vkUtil::createBuffer(inputChunk);
-
-	// fill it with index data
-	memoryLocation = logicalDevice.mapMemory(stagingBuffer.bufferMemory, 0, inputChunk.size);
-	memcpy(memoryLocation, indexLump.data(), inputChunk.size);
-	logicalDevice.unmapMemory(stagingBuffer.bufferMemory);
+	finalizationChunk.transfer->upload_buffer(vertexRegion, vertexBuffer.buffer,
+		vk::PipelineStageFlagBits::eVertexInput, vk::AccessFlagBits::eVertexAttributeRead);
 
 	// make the index buffer
+	inputChunk.size = indexRegion.size;
 	inputChunk.usage = vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eIndexBuffer;
-	inputChunk.memoryProperties = vk::MemoryPropertyFlagBits::eDeviceLocal;
 	indexBuffer = vkUtil::createBuffer(inputChunk);
 
-	// fill it index
-	vkUtil::copyBuffer(stagingBuffer, indexBuffer, inputChunk.size, finalizationChunk.queue, finalizationChunk.commandBuffer);
-
-	// destroy statging buffer
-	logicalDevice.destroyBuffer(stagingBuffer.buffer);
-	logicalDevice.freeMemory(stagingBuffer.bufferMemory);
+	// fill it
+	finalizationChunk.transfer->upload_buffer(indexRegion, indexBuffer.buffer,
+		vk::PipelineStageFlagBits::eVertexInput, vk::AccessFlagBits::eIndexRead);
 }
 
 VertexMenagerie::~VertexMenagerie() {
 
-	logicalDevice.destroyBuffer(vertexBuffer.buffer);
-	logicalDevice.freeMemory(vertexBuffer.bufferMemory);
+	vkUtil::destroyBuffer(logicalDevice, allocator, vertexBuffer);
 
-	logicalDevice.destroyBuffer(indexBuffer.buffer);
-	logicalDevice.freeMemory(indexBuffer.bufferMemory);
+	vkUtil::destroyBuffer(logicalDevice, allocator, indexBuffer);
 
 }
\ No newline at end of file
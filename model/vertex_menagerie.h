@@ -1,26 +1,36 @@
 #pragma once
 #include "../config.h"
 #include "../view/vkUtil/memory.h"
+#include "../view/vkUtil/transfer.h"
+#include "packed_vertex.h"
 
 struct vertexBufferFinalizationChunk {
 	vk::Device logicalDevice;
 	vk::PhysicalDevice physicalDevice;
-	vk::CommandBuffer commandBuffer;
-	vk::Queue queue;
+	vkUtil::MemoryAllocator* allocator;
+	vkUtil::TransferContext* transfer;
 };
 
 class VertexMenagerie {
 public:
 	VertexMenagerie();
 	~VertexMenagerie();
-	void consume(meshTypes type, std::vector<float> vertexData, std::vector<uint32_t> indexData);
+	void consume(uint32_t mesh, std::vector<float> vertexData, std::vector<uint32_t> indexData);
+	//for meshes which are packed already, like those in an asset pack
+	void consume_packed(uint32_t mesh, const std::vector<PackedVertex>& vertexData, const std::vector<uint32_t>& indexData, float radius);
 	void finalize(vertexBufferFinalizationChunk finalizationChunk);
 	Buffer vertexBuffer, indexBuffer;
-	std::unordered_map<meshTypes, int> firstIndices;
-	std::unordered_map<meshTypes, int> indexCounts;
+	//indexed by mesh handle
+	std::vector<int> firstIndices;
+	std::vector<int> indexCounts;
+	//indices count from the mesh's first vertex, which is added back when drawing
+	std::vector<int> vertexOffsets;
+	//distance from the origin to the furthest vertex
+	std::vector<float> boundingRadii;
 private:
-	int indexOffset;
+	int vertexOffset;
 	vk::Device logicalDevice;
-	std::vector<float> vertexLump;
+	vkUtil::MemoryAllocator* allocator;
+	std::vector<PackedVertex> vertexLump;
 	std::vector<uint32_t> indexLump;
 };
\ No newline at end of file
@@ -1,3 +1,7 @@
 C:\VulkanSDK\1.3.275.0\Bin\glslc.exe shader.vert -o vertex.spv
+C:\VulkanSDK\1.3.275.0\Bin\spirv-val.exe --target-env vulkan1.2 vertex.spv
 C:\VulkanSDK\1.3.275.0\Bin\glslc.exe shader.frag -o fragment.spv
+C:\VulkanSDK\1.3.275.0\Bin\spirv-val.exe --target-env vulkan1.2 fragment.spv
+C:\VulkanSDK\1.3.275.0\Bin\glslc.exe cull.comp -o cull.spv
+C:\VulkanSDK\1.3.275.0\Bin\spirv-val.exe --target-env vulkan1.2 cull.spv
 pause
\ No newline at end of file
@@ -1,11 +1,14 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
 
 layout(location = 0) in vec3 fragColor;
 layout(location = 1) in vec2 fragTexCoord;
+layout(location = 2) flat in uint fragMaterial;
 
 layout(location = 0) out vec4 outColor;
-layout(set = 1, binding = 0) uniform sampler2D material;
+// every material's texture, indexed by material handle
+layout(set = 1, binding = 0) uniform sampler2D materials[];
 
 void main() {
-	outColor = vec4(fragColor, 1.0) * texture(material, fragTexCoord);
+	outColor = vec4(fragColor, 1.0) * texture(materials[nonuniformEXT(fragMaterial)], fragTexCoord);
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #version 450
+#extension GL_ARB_shader_draw_parameters : require
 
 layout(set = 0, binding = 0) uniform UBO {
 	mat4 view;
@@ -6,19 +7,60 @@ layout(set = 0, binding = 0) uniform UBO {
 	mat4 viewProjection;
 } cameraData;
 
+// xyz: position, w: uniform scale. rotation is a unit quaternion
+struct Instance {
+	vec4 positionScale;
+	vec4 rotation;
+};
+
 layout(std140, set = 0, binding = 1) readonly buffer storageBuffer {
-	mat4 model[];
+	Instance instances[];
 } ObjectData;
 
+// indices into instances[] of what survived culling, in draw order
+layout(std430, set = 0, binding = 2) readonly buffer visibleBuffer {
+	uint visible[];
+} VisibleData;
+
+// a VkDrawIndexedIndirectCommand, then the group it draws
+struct DrawCommand {
+	uint indexCount;
+	uint instanceCount;
+	uint firstIndex;
+	int vertexOffset;
+	uint firstInstance;
+	uint groupSize;
+	float radius;
+	uint material;
+};
+
+layout(std430, set = 0, binding = 3) readonly buffer drawBuffer {
+	DrawCommand draws[];
+} DrawData;
+
+// gl_DrawIDARB counts from the first draw of each indirect call
+layout(push_constant) uniform DrawBase {
+	uint firstDraw;
+} drawBase;
+
 layout(location = 0) in vec2 vertexPosition;
 layout(location = 1) in vec3 vertexColor;
 layout(location = 2) in vec2 vertexTexCoord;
 
 layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) flat out uint fragMaterial;
+
+vec3 rotate(vec4 q, vec3 v) {
+	return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
 
 void main() {
-	gl_Position = cameraData.viewProjection * ObjectData.model[gl_InstanceIndex] * vec4(vertexPosition, 0.0, 1.0);
+	Instance instance = ObjectData.instances[VisibleData.visible[gl_InstanceIndex]];
+	vec3 worldPosition = instance.positionScale.xyz
+		+ instance.positionScale.w * rotate(instance.rotation, vec3(vertexPosition, 0.0));
+	gl_Position = cameraData.viewProjection * vec4(worldPosition, 1.0);
 	fragColor = vertexColor;
 	fragTexCoord = vertexTexCoord;
+	fragMaterial = DrawData.draws[drawBase.firstDraw + gl_DrawIDARB].material;
 }
\ No newline at end of file
@@ -0,0 +1,161 @@
+#include "../model/asset_pack.h"
+#include <cstdio>
+#include <cstring>
+
+/*
+* Checks that AssetPack::open and AssetPack::read_mesh turn down packs
+* which would make the engine read or index out of range. Each case
+* writes a pack, breaks one thing about it and tries to load it.
+* Returns nonzero if any case fails.
+*/
+
+namespace {
+
+	const char* packFilename = "asset_pack_tests.pack";
+
+	/*
+	* A valid pack: a 4x4 RGBA8 texture with its 3 levels,
+	* then a triangle. Cases change it before it's written.
+	*/
+	struct TestPack {
+		PackHeader header;
+		PackTexture texture;
+		PackMesh mesh;
+		std::vector<unsigned char> texels;
+		std::vector<PackedVertex> vertices;
+		std::vector<uint32_t> indices;
+		//bytes dropped from the end of the file
+		size_t truncate = 0;
+
+		TestPack() {
+			header = { packMagic, packVersion, 1, 1 };
+
+			texture = {};
+			memcpy(texture.name, "texture", sizeof("texture"));
+			texture.format = static_cast<uint32_t>(vk::Format::eR8G8B8A8Unorm);
+			texture.width = 4;
+			texture.height = 4;
+			texture.mipLevels = 3;
+			texture.offset = sizeof(PackHeader) + sizeof(PackTexture) + sizeof(PackMesh);
+			texture.size = (16 + 4 + 1) * 4;
+			texels.resize(texture.size, 255);
+
+			mesh = {};
+			memcpy(mesh.name, "triangle", sizeof("triangle"));
+			mesh.vertexCount = 3;
+			mesh.indexCount = 3;
+			mesh.radius = 1.0f;
+			mesh.vertexOffset = texture.offset + texture.size;
+			mesh.indexOffset = mesh.vertexOffset + 3 * sizeof(PackedVertex);
+			vertices.resize(3, PackedVertex{});
+			indices = { 0, 1, 2 };
+		}
+
+		void write() const {
+			std::vector<char> data;
+			auto append = [&](const void* src, size_t size) {
+				const char* bytes = static_cast<const char*>(src);
+				data.insert(data.end(), bytes, bytes + size);
+			};
+			append(&header, sizeof(header));
+			append(&texture, sizeof(texture));
+			append(&mesh, sizeof(mesh));
+			append(texels.data(), texels.size());
+			append(vertices.data(), vertices.size() * sizeof(PackedVertex));
+			append(indices.data(), indices.size() * sizeof(uint32_t));
+			data.resize(data.size() - truncate);
+
+			std::ofstream file(packFilename, std::ios::binary | std::ios::trunc);
+			file.write(data.data(), static_cast<std::streamsize>(data.size()));
+		}
+	};
+
+	//opens the pack and reads its mesh, like the engine does
+	bool loads(const TestPack& testPack) {
+		testPack.write();
+		AssetPack pack;
+		if (!pack.open(packFilename)) {
+			return false;
+		}
+		std::vector<PackedVertex> vertices;
+		std::vector<uint32_t> indices;
+		return pack.read_mesh(pack.meshes[0], vertices, indices);
+	}
+
+	int failures = 0;
+
+	void expect(bool loaded, bool expected, const char* name) {
+		if (loaded != expected) {
+			std::cout << "FAILED: " << name << (expected ? " should load" : " should be rejected") << std::endl;
+			++failures;
+		}
+	}
+}
+
+int main() {
+
+	TestPack pack;
+	expect(loads(pack), true, "a valid pack");
+
+	pack = TestPack();
+	pack.truncate = 1;
+	expect(loads(pack), false, "a pack missing its last byte");
+
+	pack = TestPack();
+	pack.truncate = sizeof(uint32_t) * 3 + sizeof(PackedVertex) * 3 + pack.texture.size + sizeof(PackMesh);
+	expect(loads(pack), false, "a pack cut off in its tables");
+
+	pack = TestPack();
+	pack.header.textureCount = 1000000;
+	expect(loads(pack), false, "more textures than the file holds");
+
+	pack = TestPack();
+	pack.texture.offset = 1 << 20;
+	expect(loads(pack), false, "a texture offset past the end");
+
+	pack = TestPack();
+	pack.texture.offset = UINT64_MAX - 8;
+	expect(loads(pack), false, "a texture range which overflows");
+
+	pack = TestPack();
+	pack.mesh.vertexOffset = 1 << 20;
+	expect(loads(pack), false, "a vertex offset past the end");
+
+	pack = TestPack();
+	pack.mesh.indexCount = 1 << 20;
+	expect(loads(pack), false, "more indices than the file holds");
+
+	pack = TestPack();
+	pack.indices[2] = 3;
+	expect(loads(pack), false, "an index past the mesh's vertices");
+
+	pack = TestPack();
+	pack.texture.mipLevels = 0;
+	expect(loads(pack), false, "a texture with no levels");
+
+	pack = TestPack();
+	pack.texture.mipLevels = 4;
+	pack.texture.size += 4;
+	pack.texels.resize(pack.texture.size);
+	pack.mesh.vertexOffset += 4;
+	pack.mesh.indexOffset += 4;
+	expect(loads(pack), false, "more levels than a 4x4 texture has");
+
+	pack = TestPack();
+	pack.texture.size -= 4;
+	expect(loads(pack), false, "a texture size which doesn't match its levels");
+
+	pack = TestPack();
+	pack.texture.width = 0;
+	expect(loads(pack), false, "a texture with no width");
+
+	pack = TestPack();
+	pack.texture.format = static_cast<uint32_t>(vk::Format::eR8G8B8A8Unorm) + 1;
+	expect(loads(pack), false, "a texture format the engine can't load");
+
+	std::remove(packFilename);
+	if (failures == 0) {
+		std::cout << "All asset pack tests passed" << std::endl;
+	}
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+#include "bc1_encoder.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+	uint32_t to_565(const float* color) {
+		uint32_t r = static_cast<uint32_t>(std::clamp(color[0], 0.0f, 255.0f) * 31.0f / 255.0f + 0.5f);
+		uint32_t g = static_cast<uint32_t>(std::clamp(color[1], 0.0f, 255.0f) * 63.0f / 255.0f + 0.5f);
+		uint32_t b = static_cast<uint32_t>(std::clamp(color[2], 0.0f, 255.0f) * 31.0f / 255.0f + 0.5f);
+		return (r << 11) | (g << 5) | b;
+	}
+
+	//the same expansion the GPU does
+	void from_565(uint32_t color, int* rgb) {
+		uint32_t r = (color >> 11) & 31;
+		uint32_t g = (color >> 5) & 63;
+		uint32_t b = color & 31;
+		rgb[0] = static_cast<int>((r << 3) | (r >> 2));
+		rgb[1] = static_cast<int>((g << 2) | (g >> 4));
+		rgb[2] = static_cast<int>((b << 3) | (b >> 2));
+	}
+
+	void encode_block(const unsigned char texels[16][3], unsigned char* block) {
+
+		float mean[3] = { 0.0f, 0.0f, 0.0f };
+		for (int i = 0; i < 16; ++i) {
+			for (int channel = 0; channel < 3; ++channel) {
+				mean[channel] += texels[i][channel] / 16.0f;
+			}
+		}
+
+		float covariance[3][3] = {};
+		for (int i = 0; i < 16; ++i) {
+			float d[3] = { texels[i][0] - mean[0], texels[i][1] - mean[1], texels[i][2] - mean[2] };
+			for (int row = 0; row < 3; ++row) {
+				for (int column = 0; column < 3; ++column) {
+					covariance[row][column] += d[row] * d[column];
+				}
+			}
+		}
+
+		//a few rounds of power iteration find the principal axis closely enough
+		float axis[3] = { 1.0f, 1.0f, 1.0f };
+		for (int iteration = 0; iteration < 8; ++iteration) {
+			float next[3];
+			for (int row = 0; row < 3; ++row) {
+				next[row] = covariance[row][0] * axis[0] + covariance[row][1] * axis[1] + covariance[row][2] * axis[2];
+			}
+			float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+			if (length < 1e-6f) {
+				break;
+			}
+			for (int channel = 0; channel < 3; ++channel) {
+				axis[channel] = next[channel] / length;
+			}
+		}
+
+		float low = 0.0f, high = 0.0f;
+		for (int i = 0; i < 16; ++i) {
+			float t = (texels[i][0] - mean[0]) * axis[0] + (texels[i][1] - mean[1]) * axis[1] + (texels[i][2] - mean[2]) * axis[2];
+			low = std::min(low, t);
+			high = std::max(high, t);
+		}
+		float ends[2][3];
+		for (int channel = 0; channel < 3; ++channel) {
+			ends[0][channel] = mean[channel] + high * axis[channel];
+			ends[1][channel] = mean[channel] + low * axis[channel];
+		}
+
+		//c0 > c1 selects the four colour mode
+		uint32_t c0 = to_565(ends[0]);
+		uint32_t c1 = to_565(ends[1]);
+		if (c0 < c1) {
+			std::swap(c0, c1);
+		}
+
+		int palette[4][3];
+		from_565(c0, palette[0]);
+		from_565(c1, palette[1]);
+		for (int channel = 0; channel < 3; ++channel) {
+			palette[2][channel] = (2 * palette[0][channel] + palette[1][channel]) / 3;
+			palette[3][channel] = (palette[0][channel] + 2 * palette[1][channel]) / 3;
+		}
+
+		uint32_t indices = 0;
+		if (c0 != c1) {
+			for (int i = 0; i < 16; ++i) {
+				int bestIndex = 0;
+				int bestError = INT32_MAX;
+				for (int index = 0; index < 4; ++index) {
+					int error = 0;
+					for (int channel = 0; channel < 3; ++channel) {
+						int d = texels[i][channel] - palette[index][channel];
+						error += d * d;
+					}
+					if (error < bestError) {
+						bestError = error;
+						bestIndex = index;
+					}
+				}
+				indices |= static_cast<uint32_t>(bestIndex) << (2 * i);
+			}
+		}
+
+		block[0] = static_cast<unsigned char>(c0 & 0xff);
+		block[1] = static_cast<unsigned char>(c0 >> 8);
+		block[2] = static_cast<unsigned char>(c1 & 0xff);
+		block[3] = static_cast<unsigned char>(c1 >> 8);
+		for (int i = 0; i < 4; ++i) {
+			block[4 + i] = static_cast<unsigned char>((indices >> (8 * i)) & 0xff);
+		}
+	}
+}
+
+void cooker::encode_bc1(const unsigned char* rgba, int width, int height, unsigned char* dst)
+{
+	unsigned char texels[16][3];
+
+	for (int blockY = 0; blockY < height; blockY += 4) {
+		for (int blockX = 0; blockX < width; blockX += 4) {
+
+			//blocks hanging over the edge repeat the last row and column
+			for (int y = 0; y < 4; ++y) {
+				for (int x = 0; x < 4; ++x) {
+					int sourceX = std::min(blockX + x, width - 1);
+					int sourceY = std::min(blockY + y, height - 1);
+					const unsigned char* texel = rgba + (static_cast<size_t>(sourceY) * width + sourceX) * 4;
+					std::copy(texel, texel + 3, texels[4 * y + x]);
+				}
+			}
+
+			encode_block(texels, dst);
+			dst += 8;
+		}
+	}
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include <cstdint>
+
+namespace cooker {
+
+	/**
+		Compress one level of an RGBA8 image to BC1 (opaque, alpha is dropped).
+		Each block's endpoints are found along its colours' principal axis.
+
+		\param rgba the level's texels, tightly packed
+		\param width the width of the level
+		\param height the height of the level
+		\param dst the blocks are written here, 8 bytes for every 4x4 block (partial ones rounded up)
+	*/
+	void encode_bc1(const unsigned char* rgba, int width, int height, unsigned char* dst);
+}
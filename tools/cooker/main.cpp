@@ -0,0 +1,180 @@
+#define STB_IMAGE_IMPLEMENTATION
+#include "../../model/builtin_assets.h"
+#include "../../model/asset_pack.h"
+#include "../../model/packed_vertex.h"
+#include "../../view/vkImage/mipmaps.h"
+#include "../../view/vkImage/blocks.h"
+#include "mesh_optimizer.h"
+#include "bc1_encoder.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+/*
+* Cooks the engine's assets into a pack it can upload without transforming
+* anything: textures are decoded, given their full mip chain and optionally
+* compressed, meshes have their triangles and vertices reordered for the
+* GPU's caches and their vertices quantized.
+*
+* usage: cooker [output pack] [--bc1]
+* Run from the directory the engine runs from, texture paths are relative to it.
+*/
+
+namespace {
+
+	void align(std::vector<unsigned char>& data) {
+		data.resize((data.size() + 15) / 16 * 16, 0);
+	}
+
+	void append(std::vector<unsigned char>& data, const void* source, size_t size) {
+		const unsigned char* bytes = static_cast<const unsigned char*>(source);
+		data.insert(data.end(), bytes, bytes + size);
+	}
+
+	void set_name(char* destination, const std::string& name) {
+		if (name.size() >= packNameLength) {
+			std::cout << "Name " << name << " is too long, it will be cut short" << std::endl;
+		}
+		std::memcpy(destination, name.c_str(), std::min<size_t>(name.size(), packNameLength - 1));
+	}
+
+	bool cook_texture(const MaterialSource& source, bool compress, PackTexture& texture, std::vector<unsigned char>& data) {
+
+		int width, height, channels;
+		stbi_uc* pixels = stbi_load(source.filename.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+		if (!pixels) {
+			std::cout << "Failed to load " << source.filename << std::endl;
+			return false;
+		}
+
+		vk::Format format = compress ? vk::Format::eBc1RgbUnormBlock : vk::Format::eR8G8B8A8Unorm;
+		set_name(texture.name, source.name);
+		texture.format = static_cast<uint32_t>(format);
+		texture.width = static_cast<uint32_t>(width);
+		texture.height = static_cast<uint32_t>(height);
+		texture.mipLevels = vkImage::mip_level_count(width, height);
+
+		align(data);
+		texture.offset = data.size();
+
+		std::vector<unsigned char> level(pixels, pixels + static_cast<size_t>(width) * height * 4);
+		std::vector<unsigned char> nextLevel;
+		stbi_image_free(pixels);
+
+		for (uint32_t mipLevel = 0; mipLevel < texture.mipLevels; ++mipLevel) {
+
+			size_t levelStart = data.size();
+			data.resize(levelStart + vkImage::level_size(format, width, height));
+			if (compress) {
+				cooker::encode_bc1(level.data(), width, height, data.data() + levelStart);
+			}
+			else {
+				std::copy(level.begin(), level.end(), data.begin() + levelStart);
+			}
+
+			if (mipLevel + 1 < texture.mipLevels) {
+				nextLevel.resize(static_cast<size_t>(std::max(width / 2, 1)) * std::max(height / 2, 1) * 4);
+				vkImage::downsample_rgba8(level.data(), width, height, nextLevel.data());
+				level.swap(nextLevel);
+				width = std::max(width / 2, 1);
+				height = std::max(height / 2, 1);
+			}
+		}
+
+		texture.size = data.size() - texture.offset;
+		return true;
+	}
+
+	void cook_mesh(MeshSource source, PackMesh& mesh, std::vector<unsigned char>& data) {
+
+		const size_t stride = 7;
+		source.indices = cooker::optimize_vertex_cache(source.indices, source.vertices.size() / stride);
+		cooker::optimize_vertex_fetch(source.vertices, source.indices, stride);
+
+		set_name(mesh.name, source.name);
+		mesh.vertexCount = static_cast<uint32_t>(source.vertices.size() / stride);
+		mesh.indexCount = static_cast<uint32_t>(source.indices.size());
+
+		//the radius is measured before quantizing, it only has to bound the mesh
+		mesh.radius = 0.0f;
+		std::vector<PackedVertex> vertices(mesh.vertexCount);
+		for (uint32_t vertex = 0; vertex < mesh.vertexCount; ++vertex) {
+			const float* attributes = &source.vertices[stride * vertex];
+			mesh.radius = std::max(mesh.radius, std::sqrt(attributes[0] * attributes[0] + attributes[1] * attributes[1]));
+			vertices[vertex] = pack_vertex(attributes);
+		}
+
+		align(data);
+		mesh.vertexOffset = data.size();
+		append(data, vertices.data(), sizeof(PackedVertex) * vertices.size());
+
+		align(data);
+		mesh.indexOffset = data.size();
+		append(data, source.indices.data(), sizeof(uint32_t) * source.indices.size());
+	}
+}
+
+int main(int argc, char** argv) {
+
+	std::string output = "assets.pack";
+	bool compress = false;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--bc1") == 0) {
+			compress = true;
+		}
+		else {
+			output = argv[i];
+		}
+	}
+
+	//offsets are counted from the start of the data, then moved past the tables once their size is known
+	std::vector<unsigned char> data;
+
+	std::vector<PackTexture> textures;
+	for (const MaterialSource& source : builtin_materials()) {
+		PackTexture texture = {};
+		if (cook_texture(source, compress, texture, data)) {
+			textures.push_back(texture);
+		}
+	}
+
+	std::vector<PackMesh> meshes;
+	for (const MeshSource& source : builtin_meshes()) {
+		PackMesh mesh = {};
+		cook_mesh(source, mesh, data);
+		meshes.push_back(mesh);
+	}
+
+	PackHeader header;
+	header.magic = packMagic;
+	header.version = packVersion;
+	header.textureCount = static_cast<uint32_t>(textures.size());
+	header.meshCount = static_cast<uint32_t>(meshes.size());
+
+	uint64_t dataStart = sizeof(PackHeader) + sizeof(PackTexture) * textures.size() + sizeof(PackMesh) * meshes.size();
+	dataStart = (dataStart + 15) / 16 * 16;
+	for (PackTexture& texture : textures) {
+		texture.offset += dataStart;
+	}
+	for (PackMesh& mesh : meshes) {
+		mesh.vertexOffset += dataStart;
+		mesh.indexOffset += dataStart;
+	}
+
+	std::vector<unsigned char> file;
+	append(file, &header, sizeof(header));
+	append(file, textures.data(), sizeof(PackTexture) * textures.size());
+	append(file, meshes.data(), sizeof(PackMesh) * meshes.size());
+	file.resize(dataStart, 0);
+	file.insert(file.end(), data.begin(), data.end());
+
+	std::ofstream stream(output, std::ios::binary);
+	if (!stream.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()))) {
+		std::cout << "Failed to write " << output << std::endl;
+		return 1;
+	}
+
+	std::cout << "Cooked " << textures.size() << " textures and " << meshes.size() << " meshes into "
+		<< output << " (" << file.size() << " bytes)" << std::endl;
+	return textures.size() == builtin_materials().size() ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+#include "mesh_optimizer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+	//the size of the cache being modelled, real caches vary but the order isn't sensitive to it
+	constexpr size_t cacheSize = 32;
+
+	float vertex_score(int cachePosition, uint32_t remainingTriangles) {
+
+		if (remainingTriangles == 0) {
+			return -1.0f;
+		}
+
+		float score = 0.0f;
+		if (cachePosition >= 0) {
+			//the last triangle's vertices score a little lower, so the next one doesn't just reuse its edge
+			if (cachePosition < 3) {
+				score = 0.75f;
+			}
+			else {
+				score = std::pow(1.0f - static_cast<float>(cachePosition - 3) / (cacheSize - 3), 1.5f);
+			}
+		}
+
+		//vertices with few triangles left are worth finishing off
+		return score + 2.0f / std::sqrt(static_cast<float>(remainingTriangles));
+	}
+}
+
+std::vector<uint32_t> cooker::optimize_vertex_cache(const std::vector<uint32_t>& indices, size_t vertexCount)
+{
+	size_t triangleCount = indices.size() / 3;
+
+	//the triangles using each vertex, vertex v's are [triangleStarts[v], triangleStarts[v + 1])
+	std::vector<uint32_t> triangleStarts(vertexCount + 1, 0);
+	for (uint32_t index : indices) {
+		++triangleStarts[index + 1];
+	}
+	for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+		triangleStarts[vertex + 1] += triangleStarts[vertex];
+	}
+	std::vector<uint32_t> vertexTriangles(indices.size());
+	std::vector<uint32_t> fill(triangleStarts.begin(), triangleStarts.end() - 1);
+	for (size_t i = 0; i < indices.size(); ++i) {
+		vertexTriangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+	}
+
+	std::vector<uint32_t> remaining(vertexCount);
+	std::vector<int> cachePositions(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount);
+	for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+		remaining[vertex] = triangleStarts[vertex + 1] - triangleStarts[vertex];
+		vertexScores[vertex] = vertex_score(-1, remaining[vertex]);
+	}
+
+	std::vector<float> triangleScores(triangleCount);
+	for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+		triangleScores[triangle] = vertexScores[indices[3 * triangle]]
+			+ vertexScores[indices[3 * triangle + 1]] + vertexScores[indices[3 * triangle + 2]];
+	}
+	std::vector<bool> emitted(triangleCount, false);
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+	std::vector<uint32_t> cache, nextCache;
+	size_t scanCursor = 0;
+
+	for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount) {
+
+		//the best triangle touching the cache, or at a dead end the next one not yet emitted
+		size_t best = triangleCount;
+		float bestScore = -1.0f;
+		for (uint32_t vertex : cache) {
+			for (uint32_t i = triangleStarts[vertex]; i < triangleStarts[vertex + 1]; ++i) {
+				uint32_t triangle = vertexTriangles[i];
+				if (!emitted[triangle] && triangleScores[triangle] > bestScore) {
+					best = triangle;
+					bestScore = triangleScores[triangle];
+				}
+			}
+		}
+		if (best == triangleCount) {
+			while (emitted[scanCursor]) {
+				++scanCursor;
+			}
+			best = scanCursor;
+		}
+
+		emitted[best] = true;
+		const uint32_t* triangle = &indices[3 * best];
+		result.insert(result.end(), triangle, triangle + 3);
+
+		//the triangle's vertices move to the front of the cache, the rest shift back
+		nextCache.assign(triangle, triangle + 3);
+		for (uint32_t vertex : cache) {
+			if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2]) {
+				nextCache.push_back(vertex);
+			}
+		}
+		for (int corner = 0; corner < 3; ++corner) {
+			--remaining[triangle[corner]];
+		}
+
+		//rescore every vertex which moved, including those pushed out of the cache
+		for (size_t i = 0; i < nextCache.size(); ++i) {
+			uint32_t vertex = nextCache[i];
+			cachePositions[vertex] = i < cacheSize ? static_cast<int>(i) : -1;
+			float score = vertex_score(cachePositions[vertex], remaining[vertex]);
+			float delta = score - vertexScores[vertex];
+			vertexScores[vertex] = score;
+			for (uint32_t j = triangleStarts[vertex]; j < triangleStarts[vertex + 1]; ++j) {
+				triangleScores[vertexTriangles[j]] += delta;
+			}
+		}
+		if (nextCache.size() > cacheSize) {
+			nextCache.resize(cacheSize);
+		}
+		cache.swap(nextCache);
+	}
+
+	return result;
+}
+
+void cooker::optimize_vertex_fetch(std::vector<float>& vertices, std::vector<uint32_t>& indices, size_t stride)
+{
+	size_t vertexCount = vertices.size() / stride;
+	std::vector<uint32_t> remap(vertexCount, UINT32_MAX);
+	std::vector<float> reordered;
+	reordered.reserve(vertices.size());
+
+	for (uint32_t& index : indices) {
+		if (remap[index] == UINT32_MAX) {
+			remap[index] = static_cast<uint32_t>(reordered.size() / stride);
+			reordered.insert(reordered.end(), vertices.begin() + index * stride, vertices.begin() + (index + 1) * stride);
+		}
+		index = remap[index];
+	}
+
+	vertices.swap(reordered);
+}
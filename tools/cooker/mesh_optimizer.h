@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace cooker {
+
+	/**
+		Reorder triangles so consecutive ones share vertices, which keeps them
+		in the GPU's post-transform cache. Uses Tom Forsyth's linear-speed
+		vertex cache optimisation.
+
+		\param indices a triangle list
+		\param vertexCount the number of vertices the indices refer to
+		\returns the same triangles, reordered
+	*/
+	std::vector<uint32_t> optimize_vertex_cache(const std::vector<uint32_t>& indices, size_t vertexCount);
+
+	/**
+		Reorder vertices into the order the indices first use them, so the
+		vertex fetches walk through memory. Vertices no index uses are dropped.
+
+		\param vertices the vertex data, stride floats per vertex, reordered in place
+		\param indices the triangle list, rewritten to refer to the new order
+		\param stride the number of floats in a vertex
+	*/
+	void optimize_vertex_fetch(std::vector<float>& vertices, std::vector<uint32_t>& indices, size_t stride);
+}
@@ -7,12 +7,23 @@
 #include "vkInit/commands.h"
 #include "vkInit/sync.h"
 #include "vkInit/descriptors.h"
+#include "vkUtil/transforms.h"
+#include "../model/asset_pack.h"
+#include "../model/builtin_assets.h"
+#include <algorithm>
+#include <cstring>
 
-Engine::Engine(int width, int height, GLFWwindow* window) {
+Engine::Engine(int width, int height, GLFWwindow* window, AssetRegistry* registry, int framesInFlight) {
 
 	this->width = width;
 	this->height = height;
 	this->window = window;
+	this->registry = registry;
+	maxFramesInFlight = framesInFlight;
+
+	//the rendering thread takes part in parallel work, so leave it a core
+	unsigned int cores = std::thread::hardware_concurrency();
+	threadPool = new ThreadPool(cores > 1 ? cores - 1 : 0);
 
 	vkLogging::Logger::get_logger()->print("Making a graphics engine...");
 
@@ -33,6 +44,8 @@ void Engine::make_instance() {
 
 	instance = vkInit::make_instance("ID Tech 12");
 	dldi = vk::DispatchLoaderDynamic(instance, vkGetInstanceProcAddr);
+	//make_instance enabled the surface extensions if they're available, the device is checked later
+	presentFences = vkInit::supports_surface_maintenance();
 	if (vkLogging::Logger::get_logger()->get_debug_mode()) {
 		debugMessenger = vkLogging::make_debug_messenger(instance, dldi);
 	}
@@ -51,36 +64,63 @@ void Engine::make_instance() {
 void Engine::make_device() {
 
 	physicalDevice = vkInit::choose_physical_device(instance);
-	device = vkInit::create_logical_device(physicalDevice, surface);
-	std::array<vk::Queue,2> queues = vkInit::get_queues(physicalDevice, device, surface);
+	presentFences = vkInit::supports_present_fences(physicalDevice, presentFences);
+	device = vkInit::create_logical_device(physicalDevice, surface, presentFences);
+	std::array<vk::Queue,3> queues = vkInit::get_queues(physicalDevice, device, surface);
 	graphicsQueue = queues[0];
 	presentQueue = queues[1];
+	transferQueue = queues[2];
+	allocator = new vkUtil::MemoryAllocator(device, physicalDevice);
+	deletionQueue = new vkUtil::DeletionQueue(device, allocator);
+	pipelineCache = new vkUtil::PipelineCache(device, physicalDevice, "pipeline_cache.bin");
+
+	//culling records into the graphics command buffer, so it needs a queue which can do both
+	vkUtil::QueueFamilyIndices queueFamilies = vkUtil::findQueueFamilies(physicalDevice, surface);
+	std::vector<vk::QueueFamilyProperties> familyProperties = physicalDevice.getQueueFamilyProperties();
+	gpuCulling = static_cast<bool>(familyProperties[queueFamilies.graphicsFamily.value()].queueFlags & vk::QueueFlagBits::eCompute);
+
+	//the device enables multiDrawIndirect whenever it's supported
+	maxDrawsPerCall = 1;
+	if (physicalDevice.getFeatures().multiDrawIndirect) {
+		maxDrawsPerCall = physicalDevice.getProperties().limits.maxDrawIndirectCount;
+	}
+
+	depthFormat = vkImage::find_supported_format(
+		physicalDevice,
+		{ vk::Format::eD32Sfloat, vk::Format::eD24UnormS8Uint },
+		vk::ImageTiling::eOptimal,
+		vk::FormatFeatureFlagBits::eDepthStencilAttachment
+	);
+
 	make_swapchain();
 	frameNumber = 0;
+	framesSubmitted = 0;
+	framesCompleted = 0;
 }
 
 /**
 * Make a swapchain
 */
-void Engine::make_swapchain() {
+void Engine::make_swapchain(vk::SwapchainKHR oldSwapchain) {
 
 	vkInit::SwapChainBundle bundle = vkInit::create_swapchain(
-		device, physicalDevice, surface, width, height
+		device, physicalDevice, surface, width, height, oldSwapchain
 	);
 	swapchain = bundle.swapchain;
 	swapchainFrames = bundle.frames;
 	swapchainFormat = bundle.format;
 	swapchainExtent = bundle.extent;
-	maxFramesInFlight = static_cast<int>(swapchainFrames.size());
-
 
 	for (auto& frame : swapchainFrames) {
 		frame.logicalDevice = device;
 		frame.physicalDevice = physicalDevice;
+		frame.allocator = allocator;
 		frame.width = swapchainExtent.width;
 		frame.height = swapchainExtent.height;
+		frame.depthFormat = depthFormat;
 
 		frame.make_depth_resources();
+		frame.renderFinished = vkInit::make_semaphore(device);
 	}
 }
 
@@ -96,42 +136,133 @@ void Engine::recreate_swapchain() {
 		glfwWaitEvents();
 	}
 
-	device.waitIdle();
+	/*
+	* Frames in flight may still be drawing to or presenting the old images.
+	* The timeline only says when a frame's drawing finished, not its present.
+	* Frame contexts, pipelines and everything else not sized to the swapchain are kept.
+	*/
+	std::vector<vkUtil::SwapChainFrame> oldFrames = swapchainFrames;
+	vk::SwapchainKHR oldSwapchain = swapchain;
+
+	if (!presentFences) {
+		/*
+		* Without present fences nothing signals when a present is done with its image.
+		* Idling the device waits for the present queue too, the spec doesn't strictly
+		* promise that covers the presentation engine but it's what drivers without the
+		* extension expect, so the old swapchain is destroyed after it.
+		*/
+		device.waitIdle();
+		make_swapchain(oldSwapchain);
+		make_framebuffers();
+		for (vkUtil::SwapChainFrame& frame : oldFrames) {
+			frame.destroy();
+		}
+		device.destroySwapchainKHR(oldSwapchain);
+		return;
+	}
 
-	cleanup_swapchain();
-	make_swapchain();
+	make_swapchain(oldSwapchain);
 	make_framebuffers();
-	make_frame_resources();
-	vkInit::commandBufferInputChunk commandBufferInput = { device, commandPool, swapchainFrames };
-	vkInit::make_frame_command_buffers(commandBufferInput);
+
+	/*
+	* Every present to the old swapchain signaled its frame context's present fence,
+	* so those fences go with the old swapchain and the contexts get new ones.
+	* Once the last frame's drawing is done its present has been queued, and
+	* when the fences are signaled the old images and semaphores are free.
+	*/
+	std::vector<vk::Fence> oldFences;
+	for (vkUtil::FrameContext& frame : frameContexts) {
+		oldFences.push_back(frame.presentFence);
+		frame.presentFence = vkInit::make_fence(device);
+	}
+	vk::Device logicalDevice = device;
+	deletionQueue->push(framesSubmitted, [logicalDevice, oldFences, oldFrames]() mutable {
+		logicalDevice.waitForFences(oldFences, VK_TRUE, UINT64_MAX);
+		for (vk::Fence fence : oldFences) {
+			logicalDevice.destroyFence(fence);
+		}
+		for (vkUtil::SwapChainFrame& frame : oldFrames) {
+			frame.destroy();
+		}
+	});
+	deletionQueue->push(framesSubmitted, oldSwapchain);
 
 }
 
 void Engine::make_descriptor_set_layouts()
 {
 	vkInit::DescriptorSetLayoutData bindings;
-	bindings.count = 2;
+	bindings.count = 4;
 
+	//all live in the frame arena, their offsets are given when binding
 	bindings.indices.push_back(0);
-	bindings.types.push_back(vk::DescriptorType::eUniformBuffer);
+	bindings.types.push_back(vk::DescriptorType::eUniformBufferDynamic);
 	bindings.counts.push_back(1);
 	bindings.stages.push_back(vk::ShaderStageFlagBits::eVertex);
 
 	bindings.indices.push_back(1);
-	bindings.types.push_back(vk::DescriptorType::eStorageBuffer);
+	bindings.types.push_back(vk::DescriptorType::eStorageBufferDynamic);
+	bindings.counts.push_back(1);
+	bindings.stages.push_back(vk::ShaderStageFlagBits::eVertex);
+
+	//indices of the instances which survived culling
+	bindings.indices.push_back(2);
+	bindings.types.push_back(vk::DescriptorType::eStorageBufferDynamic);
+	bindings.counts.push_back(1);
+	bindings.stages.push_back(vk::ShaderStageFlagBits::eVertex);
+
+	//the draw commands, for each draw's material
+	bindings.indices.push_back(3);
+	bindings.types.push_back(vk::DescriptorType::eStorageBufferDynamic);
 	bindings.counts.push_back(1);
 	bindings.stages.push_back(vk::ShaderStageFlagBits::eVertex);
 
 	frameDescriptorSetLayout = vkInit::make_descriptor_set_layout(device, bindings);
 
+	if (gpuCulling) {
+		vkInit::DescriptorSetLayoutData cull_bindings;
+		cull_bindings.count = 4;
+
+		//frame parameters, then the instances, visible list and draw commands
+		cull_bindings.indices.push_back(0);
+		cull_bindings.types.push_back(vk::DescriptorType::eUniformBufferDynamic);
+		cull_bindings.counts.push_back(1);
+		cull_bindings.stages.push_back(vk::ShaderStageFlagBits::eCompute);
+
+		for (int binding = 1; binding < 4; ++binding) {
+			cull_bindings.indices.push_back(binding);
+			cull_bindings.types.push_back(vk::DescriptorType::eStorageBufferDynamic);
+			cull_bindings.counts.push_back(1);
+			cull_bindings.stages.push_back(vk::ShaderStageFlagBits::eCompute);
+		}
+
+		cullDescriptorSetLayout = vkInit::make_descriptor_set_layout(device, cull_bindings);
+	}
+
+	//every material's texture in one array, indexed by material handle
+	auto properties = physicalDevice.getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceDescriptorIndexingPropertiesEXT>();
+	const vk::PhysicalDeviceDescriptorIndexingPropertiesEXT& indexingProperties = properties.get<vk::PhysicalDeviceDescriptorIndexingPropertiesEXT>();
+	materialCapacity = std::min({ 1024u,
+		indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers,
+		indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+		indexingProperties.maxDescriptorSetUpdateAfterBindSamplers,
+		indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages
+	});
+
 	vkInit::DescriptorSetLayoutData mesh_bindings;
 	mesh_bindings.count = 1;
 
 	mesh_bindings.indices.push_back(0);
 	mesh_bindings.types.push_back(vk::DescriptorType::eCombinedImageSampler);
-	mesh_bindings.counts.push_back(1);
+	mesh_bindings.counts.push_back(materialCapacity);
 	mesh_bindings.stages.push_back(vk::ShaderStageFlagBits::eFragment);
 
+	//slots are filled in as textures load, even while frames using the array are in flight
+	mesh_bindings.bindingFlags.push_back(
+		vk::DescriptorBindingFlagBitsEXT::ePartiallyBound | vk::DescriptorBindingFlagBitsEXT::eUpdateAfterBind
+	);
+	mesh_bindings.layoutFlags = vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPoolEXT;
+
 	meshDescriptorSetLayout = vkInit::make_descriptor_set_layout(device, mesh_bindings);
 }
 
@@ -141,19 +272,50 @@ void Engine::make_pipeline() {
 	specification.device = device;
 	specification.vertexFilepath = "shaders/vertex.spv";
 	specification.fragmentFilepath = "shaders/fragment.spv";
-	specification.swapchainExtent = swapchainExtent;
 	specification.swapchainImageFormat = swapchainFormat;
-	specification.depthFormat = swapchainFrames[0].depthFormat;
+	specification.depthFormat = depthFormat;
 	specification.descriptorSetLayouts = { frameDescriptorSetLayout, meshDescriptorSetLayout };
 
-	vkInit::GraphicsPipelineOutBundle output = vkInit::create_graphics_pipeline(
-		specification
-	);
+	//index of the first draw of each indirect call, gl_DrawID counts from there
+	vk::PushConstantRange drawBase;
+	drawBase.stageFlags = vk::ShaderStageFlagBits::eVertex;
+	drawBase.offset = 0;
+	drawBase.size = sizeof(uint32_t);
+	specification.pushConstantRanges = { drawBase };
+
+	vkInit::ComputePipelineInBundle cullSpecification = {};
+	cullSpecification.device = device;
+	cullSpecification.computeFilepath = "shaders/cull.spv";
+	cullSpecification.descriptorSetLayouts = { cullDescriptorSetLayout };
+
+	/*
+	* Pipelines are built at once, each thread filling a cache of its own
+	* which is merged into the engine's afterwards.
+	*/
+	vkInit::GraphicsPipelineOutBundle output;
+	vkInit::ComputePipelineOutBundle cullOutput;
+	threadPool->parallel_for(gpuCulling ? 2 : 1, [&](size_t i) {
+		vk::PipelineCache workerCache = pipelineCache->make_worker_cache();
+		if (i == 0) {
+			specification.pipelineCache = workerCache;
+			output = vkInit::create_graphics_pipeline(specification);
+		}
+		else {
+			cullSpecification.pipelineCache = workerCache;
+			cullOutput = vkInit::create_compute_pipeline(cullSpecification);
+		}
+		pipelineCache->merge(workerCache);
+	});
 
 	pipelineLayout = output.layout;
 	renderpass = output.renderpass;
 	pipeline = output.pipeline;
 
+	if (gpuCulling) {
+		cullPipelineLayout = cullOutput.layout;
+		cullPipeline = cullOutput.pipeline;
+	}
+
 }
 
 /**
@@ -170,29 +332,60 @@ void Engine::make_framebuffers() {
 }
 
 /**
-* Make synchronization objects for each frame
+* Make the command buffer, synchronization objects and resources of each frame context
 */
-void Engine::make_frame_resources() {
+void Engine::make_frame_contexts() {
 	vkInit::DescriptorSetLayoutData bindings;
-	bindings.count = 2;
-	bindings.types.push_back(vk::DescriptorType::eUniformBuffer);
-	bindings.types.push_back(vk::DescriptorType::eStorageBuffer);
+	bindings.count = 4;
+	bindings.types.push_back(vk::DescriptorType::eUniformBufferDynamic);
+	bindings.types.push_back(vk::DescriptorType::eStorageBufferDynamic);
+	bindings.types.push_back(vk::DescriptorType::eStorageBufferDynamic);
+	bindings.types.push_back(vk::DescriptorType::eStorageBufferDynamic);
 
-	frameDescriptorPool = vkInit::make_descriptor_pool(device, static_cast<uint32_t>(swapchainFrames.size()), bindings);
-	
+	//with GPU culling every frame has a second set, laid out the same way
+	uint32_t setsPerFrame = gpuCulling ? 2 : 1;
+
+	frameDescriptorPool = vkInit::make_descriptor_pool(device, setsPerFrame * static_cast<uint32_t>(maxFramesInFlight), bindings);
 
-	// descriptorSetLayout = vkInit::make_descriptor_set_layout(device, bindings);
+	frameTimeline = vkInit::make_timeline_semaphore(device);
+
+	frameContexts.resize(maxFramesInFlight);
+	for (vkUtil::FrameContext& frame : frameContexts) {
+		frame.logicalDevice = device;
+		frame.physicalDevice = physicalDevice;
+		frame.allocator = allocator;
 
-	for (vkUtil::SwapChainFrame& frame : swapchainFrames) {
 		frame.imageAvailable = vkInit::make_semaphore(device);
-		frame.renderFinished = vkInit::make_semaphore(device);
-		frame.inFlight = vkInit::make_fence(device);
+		frame.submission = 0;
+		frame.presentFence = presentFences ? vkInit::make_fence(device) : nullptr;
 
-		frame.make_descriptor_resources();
+		//a starting point, each arena grows when its frame needs more
+		frame.make_descriptor_resources(1024 * 1024);
 
+		//the arena's buffer never changes, only the offsets it's bound at
 		frame.descriptorSet = vkInit::allocate_descriptor_set(device, frameDescriptorPool, frameDescriptorSetLayout);
+		if (gpuCulling) {
+			frame.cullDescriptorSet = vkInit::allocate_descriptor_set(device, frameDescriptorPool, cullDescriptorSetLayout);
+		}
+		frame.write_descriptor_set();
 	}
 
+	vkInit::commandBufferInputChunk commandBufferInput = { device, commandPool, frameContexts };
+	vkInit::make_frame_command_buffers(commandBufferInput);
+
+	std::stringstream message;
+	message << "Packing instance records with the " << vkUtil::instance_kernel_name() << " kernel";
+	vkLogging::Logger::get_logger()->print(message.str());
+
+	message.str("");
+	if (gpuCulling) {
+		message << "Culling in a compute pass";
+	}
+	else {
+		message << "Culling with the " << vkUtil::culling_kernel_name() << " kernel on "
+			<< threadPool->thread_count() << " threads";
+	}
+	vkLogging::Logger::get_logger()->print(message.str());
 }
 
 void Engine::finalize_setup() {
@@ -201,100 +394,181 @@ void Engine::finalize_setup() {
 
 	commandPool = vkInit::make_command_pool(device, physicalDevice, surface);
 
-	vkInit::commandBufferInputChunk commandBufferInput = { device, commandPool, swapchainFrames };
-	mainCommandBuffer = vkInit::make_command_buffer(commandBufferInput);
-	vkInit::make_frame_command_buffers(commandBufferInput);
-
-	make_frame_resources();
+	make_frame_contexts();
 	
 }
 
 void Engine::make_assets() {
 
-	meshes = new VertexMenagerie();
+	//every upload stages its data through this ring
+	stagingRing = new vkUtil::StagingRing(device, physicalDevice, allocator, 64 * 1024 * 1024);
 
-	std::vector<float> vertices = { {
-		 0.0f, -0.1f, 0.0f, 1.0f, 0.0f, 0.5f, 0.0f, //0
-		 0.1f, 0.1f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f,  // 1
-		-0.1f, 0.1f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f   // 2
-	} };
-	std::vector<uint32_t> indices = { {
-			0, 1, 2
-	} };
-	meshTypes type = meshTypes::TRIANGLE;
-	meshes->consume(type, vertices, indices);
-	
-	vertices = { {
-		-0.1f,  0.1f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f,	// 0
-		-0.1f, -0.1f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f,	// 1
-		 0.1f, -0.1f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f,	// 2
-		 0.1f,  0.1f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f,	// 3
-	} };
-	indices = { {
-			0, 1, 2, 
-			2, 3, 0
-	} };
-
-	type = meshTypes::SQUARE;
-	meshes->consume(type, vertices, indices);
-
-	vertices = { {
-		-0.1f, -0.05f, 1.0f, 1.0f, 1.0f, 0.0f, 0.25f, //0
-		-0.04f, -0.05f, 1.0f, 1.0f, 1.0f, 0.3f, 0.25f, //1
-		-0.06f,   0.0f, 1.0f, 1.0f, 1.0f, 0.2f,  0.5f, //2
-		  0.0f,  -0.1f, 1.0f, 1.0f, 1.0f, 0.5f,  0.0f, //3
-		 0.04f, -0.05f, 1.0f, 1.0f, 1.0f, 0.7f, 0.25f, //4
-		  0.1f, -0.05f, 1.0f, 1.0f, 1.0f, 1.0f, 0.25f, //5
-		 0.06f,   0.0f, 1.0f, 1.0f, 1.0f, 0.8f,  0.5f, //6
-		 0.08f,   0.1f, 1.0f, 1.0f, 1.0f, 0.9f,  1.0f, //7
-		  0.0f,  0.02f, 1.0f, 1.0f, 1.0f, 0.5f,  0.6f, //8
-		-0.08f,   0.1f, 1.0f, 1.0f, 1.0f, 0.1f,  1.0f  //9
-	} };
-	indices = { {
-			0, 1, 2,
-			1, 3, 4,
-			2, 1, 4,
-			4, 5, 6,
-			2, 4, 6,
-			6, 7, 8,
-			2, 6, 8,
-			2, 8, 9,
-	} };
-	type = meshTypes::STAR;
-	meshes->consume(type, vertices, indices);
+	//uploads run on their own queue (a dedicated one if the device has it) so they can overlap rendering
+	vkUtil::QueueFamilyIndices queueFamilies = vkUtil::findQueueFamilies(physicalDevice, surface);
+	transferCommandPool = vkInit::make_command_pool(device, queueFamilies.transferFamily.value());
+	transfer = new vkUtil::TransferContext(
+		device, transferQueue, transferCommandPool,
+		queueFamilies.transferFamily.value(), queueFamilies.graphicsFamily.value(), stagingRing
+	);
+
+	//a cooked pack is uploaded as it is, without one the builtin assets are built from source
+	AssetPack pack;
+	bool packed = pack.open("assets.pack");
+
+	//every mesh is read before any is registered, so a pack with a bad one can be dropped as a whole
+	std::vector<std::vector<PackedVertex>> packedVertices;
+	std::vector<std::vector<uint32_t>> packedIndices;
+	for (size_t i = 0; packed && i < pack.meshes.size(); ++i) {
+		const PackMesh& mesh = pack.meshes[i];
+		packedVertices.emplace_back();
+		packedIndices.emplace_back();
+		if (!pack.read_mesh(mesh, packedVertices.back(), packedIndices.back())) {
+			vkLogging::Logger::get_logger()->print_list({ std::string("Failed to load mesh ") + mesh.name + " from assets.pack" });
+			packed = false;
+		}
+	}
+	vkLogging::Logger::get_logger()->print(packed ? "Loading assets from assets.pack" : "No usable asset pack, loading assets from source");
+
+	meshes = new VertexMenagerie();
+	if (packed) {
+		for (size_t i = 0; i < pack.meshes.size(); ++i) {
+			const PackMesh& mesh = pack.meshes[i];
+			meshes->consume_packed(registry->register_mesh(mesh.name), packedVertices[i], packedIndices[i], mesh.radius);
+		}
+	}
+	else {
+		for (const MeshSource& mesh : builtin_meshes()) {
+			meshes->consume(registry->register_mesh(mesh.name), mesh.vertices, mesh.indices);
+		}
+	}
 
 	vertexBufferFinalizationChunk finalizationInfo;
 	finalizationInfo.logicalDevice = device;
 	finalizationInfo.physicalDevice = physicalDevice;
-	finalizationInfo.commandBuffer = mainCommandBuffer;
-	finalizationInfo.queue = graphicsQueue;
+	finalizationInfo.allocator = allocator;
+	finalizationInfo.transfer = transfer;
 	meshes->finalize(finalizationInfo);
 
 	// Materials
-	std::unordered_map<meshTypes, const char*> filenames{
-		{meshTypes::TRIANGLE, "tex/brick_wall.jpg"},
-		{meshTypes::SQUARE, "tex/wood_texture.jpg"},
-		{meshTypes::STAR, "tex/ground_texture.jpg"}
-	};
-
-	// Make a descriptor pool
+	// One descriptor set holds every material
 	vkInit::DescriptorSetLayoutData bindings;
 	bindings.count = 1;
 	bindings.types.push_back(vk::DescriptorType::eCombinedImageSampler);
-	meshDescriptorPool = vkInit::make_descriptor_pool(device, static_cast<uint32_t>(filenames.size()), bindings);
+	bindings.counts.push_back(materialCapacity);
+	meshDescriptorPool = vkInit::make_descriptor_pool(device, 1, bindings, vk::DescriptorPoolCreateFlagBits::eUpdateAfterBindEXT);
+	materialDescriptorSet = vkInit::allocate_descriptor_set(device, meshDescriptorPool, meshDescriptorSetLayout);
 
 	vkImage::TextureInputChunk textureInfo;
-	textureInfo.commandBuffer = mainCommandBuffer;
-	textureInfo.queue = graphicsQueue;
+	textureInfo.transfer = transfer;
 	textureInfo.logicalDevice = device;
 	textureInfo.physicalDevice = physicalDevice;
-	textureInfo.layout = meshDescriptorSetLayout; /// change this!!! ---> done
-	textureInfo.descriptorPool = meshDescriptorPool; /// change this ---> done
+	textureInfo.allocator = allocator;
+	textureInfo.descriptorSet = materialDescriptorSet;
+
+	/*
+	* Materials which fail to load still get a handle, their slot points
+	* at a 1x1 magenta texture so scenes using them draw something visible.
+	*/
+	std::vector<vkUtil::StagingRegion> fallbackStaging = transfer->stage_all({ 4 });
+	const unsigned char magenta[] = { 255, 0, 255, 255 };
+	memcpy(fallbackStaging[0].data, magenta, sizeof(magenta));
+	textureInfo.decoded = {};
+	textureInfo.decoded.pixels = static_cast<stbi_uc*>(fallbackStaging[0].data);
+	textureInfo.decoded.width = 1;
+	textureInfo.decoded.height = 1;
+	textureInfo.decoded.channels = 4;
+	textureInfo.decoded.format = vk::Format::eR8G8B8A8Unorm;
+	textureInfo.decoded.mipLevels = 1;
+	textureInfo.decoded.levels = 1;
+	textureInfo.staging = fallbackStaging[0];
+	textureInfo.slot = registry->register_material("<fallback>");
+	fallbackTexture = new vkImage::Texture(textureInfo);
+
+	//decides which levels are made while decoding and which formats are kept compressed
+	vkImage::TextureSupport textureSupport = vkImage::query_texture_support(physicalDevice);
+	std::vector<std::string> materialNames;
+	std::vector<vk::DeviceSize> stagingSizes;
+	std::vector<MaterialSource> sources;
+	if (packed) {
+		for (const PackTexture& texture : pack.textures) {
+			materialNames.push_back(texture.name);
+			stagingSizes.push_back(vkImage::packed_texture_size(texture, textureSupport));
+		}
+	}
+	else {
+		sources = builtin_materials();
+		for (const MaterialSource& source : sources) {
+			materialNames.push_back(source.name);
+			stagingSizes.push_back(vkImage::decoded_size(source.filename.c_str(), textureSupport));
+		}
+	}
+
+	/*
+	* Decoding (or reading, from a pack) dominates, so textures are loaded at
+	* once, straight into staging memory. As many as fit in the staging ring go in each batch.
+	*/
+	size_t first = 0;
+	while (first < materialNames.size()) {
+
+		size_t last = first;
+		vk::DeviceSize batchSize = 0;
+		while (last < materialNames.size() && (last == first || batchSize + stagingSizes[last] + 16 <= stagingRing->capacity)) {
+			batchSize += stagingSizes[last] + 16;
+			++last;
+		}
+
+		std::vector<vkUtil::StagingRegion> regions = transfer->stage_all(
+			std::vector<vk::DeviceSize>(stagingSizes.begin() + first, stagingSizes.begin() + last));
+		std::vector<vkImage::DecodedImage> decodedImages(last - first);
+		threadPool->parallel_for(last - first, [&](size_t i) {
+			decodedImages[i] = packed
+				? vkImage::read_packed_texture(pack, pack.textures[first + i], regions[i], textureSupport)
+				: vkImage::decode_image(sources[first + i].filename.c_str(), regions[i], textureSupport);
+		});
+
+		for (size_t i = first; i < last; ++i) {
+			const std::string& name = materialNames[i];
+			//handles count up, so a new name gets the next slot, it isn't registered if that's past the array
+			if (registry->find_material(name) == AssetRegistry::invalidHandle && registry->material_count() >= materialCapacity) {
+				vkLogging::Logger::get_logger()->print_list({ "No room in the material array for ", name });
+				continue;
+			}
+			uint32_t material = registry->register_material(name);
+			if (material >= materials.size()) {
+				materials.resize(material + 1, nullptr);
+			}
+			//a name loaded twice replaces the texture
+			release_material(material);
+			if (!decodedImages[i - first].pixels) {
+				fallbackTexture->write_descriptor(material);
+				continue;
+			}
+			textureInfo.decoded = decodedImages[i - first];
+			textureInfo.staging = regions[i - first];
+			textureInfo.slot = material;
+			materials[material] = new vkImage::Texture(textureInfo);
+		}
+
+		first = last;
+	}
+
+	/*
+	* One submission for every asset. The first frame to be rendered
+	* acquires the uploads and waits on them, so there's no need to wait here.
+	*/
+	transfer->submit();
+}
+
+void Engine::release_material(uint32_t material) {
 
-	for (const auto& [object, filename] : filenames) {
-		textureInfo.filename = filename;
-		materials[object] = new vkImage::Texture(textureInfo);
+	if (material >= materials.size() || !materials[material]) {
+		return;
 	}
+
+	//the first frame waits on the uploads, so nothing is freed before it's done either
+	materials[material]->retire(*deletionQueue, std::max<uint64_t>(framesSubmitted, 1));
+	delete materials[material];
+	materials[material] = nullptr;
 }
 
 void Engine::prepare_scene(vk::CommandBuffer commandBuffer) {
@@ -305,10 +579,10 @@ void Engine::prepare_scene(vk::CommandBuffer commandBuffer) {
 	commandBuffer.bindIndexBuffer(meshes->indexBuffer.buffer, 0, vk::IndexType::eUint32);
 }
 
-void Engine::prepare_frame(uint32_t imageIndex, Scene* scene)
+void Engine::prepare_frame(Scene* scene)
 {
 
-	vkUtil::SwapChainFrame& _frame = swapchainFrames[imageIndex];
+	vkUtil::FrameContext& _frame = frameContexts[frameNumber];
 
 	glm::vec3 eye = { 1.0f, 0.0f, 1.0f };
 	glm::vec3 center = { 0.0f, 0.0f, 0.0f };
@@ -323,30 +597,178 @@ void Engine::prepare_frame(uint32_t imageIndex, Scene* scene)
 
 	projection[1][1] += -1;
 
-	_frame.cameraData.view = view;
-	_frame.cameraData.projection = projection;
-	_frame.cameraData.viewProjection = projection * view;
-	memcpy(_frame.cameraDataWriteLocation, &(_frame.cameraData), sizeof(vkUtil::UBO));
+	size_t instanceCount = scene->transforms.size();
+
+	//the GPU is done with everything this context wrote last time
+	size_t drawCount = scene->groups.size();
+	_frame.begin_arena(
+		sizeof(vkUtil::UBO) + sizeof(vkUtil::CullParams) + drawCount * sizeof(vkUtil::DrawCommand)
+		+ instanceCount * (sizeof(vkUtil::InstanceRecord) + sizeof(uint32_t)), 5
+	);
+
+	/*
+	* The instance block is carved first so it lands at the same offset every
+	* time, and what this context wrote last time is still there.
+	*/
+	vkUtil::ArenaAllocation modelBlock = _frame.arena->allocate_storage(instanceCount * sizeof(vkUtil::InstanceRecord));
+	vkUtil::InstanceRecord* instances = static_cast<vkUtil::InstanceRecord*>(modelBlock.data);
+	_frame.modelBufferOffset = modelBlock.offset;
+
+	const TransformStorage& transforms = scene->transforms;
+	vkUtil::TransformBatch batch = {
+		transforms.x.data(), transforms.y.data(), transforms.z.data(),
+		transforms.qx.data(), transforms.qy.data(), transforms.qz.data(), transforms.qw.data(),
+		transforms.scale.data()
+	};
 
-	size_t i = 0;
-	for (glm::vec3& position : scene->trianglePositions) {
-		_frame.modelTransforms[i++] = glm::translate(glm::mat4(1.0f), position);
+	if (!_frame.transformsValid || _frame.transformCount != instanceCount || _frame.transformVersion < scene->logStart) {
+		vkUtil::pack_instance_records(batch, 0, instanceCount, instances);
+	}
+	else {
+		auto firstUnseen = std::find_if(scene->edits.begin(), scene->edits.end(),
+			[&](const TransformEdit& edit) { return edit.version > _frame.transformVersion; });
+		for (auto edit = firstUnseen; edit != scene->edits.end(); ++edit) {
+			vkUtil::pack_instance_records(batch, edit->first, edit->count, instances);
+		}
 	}
+	_frame.transformVersion = scene->version;
+	_frame.transformCount = instanceCount;
+	_frame.transformsValid = true;
+
+	//edits every context has uploaded aren't needed anymore
+	uint64_t syncedVersion = scene->version;
+	for (vkUtil::FrameContext& frame : frameContexts) {
+		syncedVersion = std::min(syncedVersion, frame.transformsValid ? frame.transformVersion : 0);
+	}
+	scene->trim_edits(syncedVersion);
 
-	for (glm::vec3& position : scene->squarePositions) {
-		_frame.modelTransforms[i++] = glm::translate(glm::mat4(1.0f), position);
+	/*
+	* Every instance is still uploaded so the delta uploads above keep working,
+	* culling only decides which of them get drawn.
+	*/
+	vkUtil::ArenaAllocation visibleBlock = _frame.arena->allocate_storage(instanceCount * sizeof(uint32_t));
+	_frame.visibleBufferOffset = visibleBlock.offset;
+	vkUtil::Frustum frustum = vkUtil::make_frustum(projection * view);
+	if (gpuCulling) {
+		write_cull_params(scene, frustum, _frame);
+	}
+	else {
+		cull_instances(scene, frustum, static_cast<uint32_t*>(visibleBlock.data), _frame);
 	}
+	write_draw_commands(_frame);
+
+	vkUtil::ArenaAllocation cameraBlock = _frame.arena->allocate_uniform(sizeof(vkUtil::UBO));
+	vkUtil::UBO* cameraData = static_cast<vkUtil::UBO*>(cameraBlock.data);
+	cameraData->view = view;
+	cameraData->projection = projection;
+	cameraData->viewProjection = projection * view;
+	_frame.cameraDataOffset = cameraBlock.offset;
+}
 
-	for (glm::vec3& position : scene->starPositions) {
-		_frame.modelTransforms[i++] = glm::translate(glm::mat4(1.0f), position);
+void Engine::write_cull_params(Scene* scene, const vkUtil::Frustum& frustum, vkUtil::FrameContext& frame)
+{
+	vkUtil::ArenaAllocation paramsBlock = frame.arena->allocate_uniform(sizeof(vkUtil::CullParams));
+	vkUtil::CullParams* params = static_cast<vkUtil::CullParams*>(paramsBlock.data);
+	params->frustum = frustum;
+	params->instanceCount = static_cast<uint32_t>(scene->transforms.size());
+	params->drawCount = static_cast<uint32_t>(scene->groups.size());
+	frame.cullParamsOffset = paramsBlock.offset;
+
+	//the compute pass fills in the counts, so every group keeps its own slots of the visible list
+	frame.drawRanges.clear();
+	for (const InstanceGroup& group : scene->groups) {
+		frame.drawRanges.push_back({ group.mesh, group.material, group.first, group.count });
 	}
+}
+
+void Engine::write_draw_commands(vkUtil::FrameContext& frame)
+{
+	uint32_t drawCount = static_cast<uint32_t>(frame.drawRanges.size());
+
+	/*
+	* One command per draw range, built from the mesh's place in the vertex menagerie.
+	* The CPU's work depends on the number of groups, not of instances.
+	*/
+	vkUtil::ArenaAllocation drawBlock = frame.arena->allocate_storage(drawCount * sizeof(vkUtil::DrawCommand));
+	vkUtil::DrawCommand* draws = static_cast<vkUtil::DrawCommand*>(drawBlock.data);
+	frame.drawCommandsOffset = drawBlock.offset;
+
+	for (uint32_t i = 0; i < drawCount; ++i) {
+		const vkUtil::DrawRange& range = frame.drawRanges[i];
+		draws[i].command.indexCount = meshes->indexCounts[range.mesh];
+		draws[i].command.instanceCount = gpuCulling ? 0 : range.instanceCount;
+		draws[i].command.firstIndex = meshes->firstIndices[range.mesh];
+		draws[i].command.vertexOffset = meshes->vertexOffsets[range.mesh];
+		draws[i].command.firstInstance = range.firstInstance;
+		draws[i].groupSize = range.instanceCount;
+		draws[i].radius = meshes->boundingRadii[range.mesh];
+		draws[i].material = range.material;
+	}
+}
 
-	memcpy(_frame.modelBufferWriteLocation, _frame.modelTransforms.data(), i * sizeof(glm::mat4));
+void Engine::cull_instances(Scene* scene, const vkUtil::Frustum& frustum, uint32_t* visible, vkUtil::FrameContext& frame)
+{
+	const TransformStorage& transforms = scene->transforms;
+	vkUtil::TransformBatch batch = {
+		transforms.x.data(), transforms.y.data(), transforms.z.data(),
+		transforms.qx.data(), transforms.qy.data(), transforms.qz.data(), transforms.qw.data(),
+		transforms.scale.data()
+	};
+
+	//large groups are split up so their work spreads across threads
+	const uint32_t chunkSize = 16384;
+	cullChunks.clear();
+	for (uint32_t i = 0; i < scene->groups.size(); ++i) {
+		const InstanceGroup& group = scene->groups[i];
+		for (uint32_t first = group.first; first < group.first + group.count; first += chunkSize) {
+			cullChunks.push_back({ i, first, std::min(chunkSize, group.first + group.count - first), 0 });
+		}
+	}
+
+	/*
+	* Chunks cull into scratch space at their own instances' slots, so
+	* they can run in any order without sharing an output cursor.
+	*/
+	cullScratch.resize(transforms.size());
+	auto cull_chunk = [&](size_t i) {
+		CullChunk& chunk = cullChunks[i];
+		float radius = meshes->boundingRadii[scene->groups[chunk.group].mesh];
+		chunk.visibleCount = vkUtil::cull_spheres(frustum, batch, radius,
+			chunk.first, chunk.count, cullScratch.data() + chunk.first);
+	};
+
+	//waking the workers costs more than culling a small scene
+	if (transforms.size() < 2 * chunkSize) {
+		for (size_t i = 0; i < cullChunks.size(); ++i) {
+			cull_chunk(i);
+		}
+	}
+	else {
+		threadPool->parallel_for(cullChunks.size(), cull_chunk);
+	}
 
-	_frame.write_descriptor_set();
+	//pack the survivors, group by group, into one draw range each, groups with none get no draw
+	frame.drawRanges.clear();
+	uint32_t visibleCount = 0;
+	size_t chunk = 0;
+	for (uint32_t i = 0; i < scene->groups.size(); ++i) {
+
+		vkUtil::DrawRange range = { scene->groups[i].mesh, scene->groups[i].material, visibleCount, 0 };
+		for (; chunk < cullChunks.size() && cullChunks[chunk].group == i; ++chunk) {
+			const CullChunk& source = cullChunks[chunk];
+			memcpy(visible + visibleCount, cullScratch.data() + source.first, source.visibleCount * sizeof(uint32_t));
+			visibleCount += source.visibleCount;
+			range.instanceCount += source.visibleCount;
+		}
+
+		if (range.instanceCount > 0) {
+			frame.drawRanges.push_back(range);
+		}
+	}
 }
 
-void Engine::record_draw_commands(vk::CommandBuffer commandBuffer, uint32_t imageIndex, Scene* scene) {
+void Engine::record_draw_commands(vk::CommandBuffer commandBuffer, uint32_t imageIndex, Scene* scene,
+	std::vector<vk::Semaphore>& waitSemaphores, std::vector<uint64_t>& waitValues, std::vector<vk::PipelineStageFlags>& waitStages) {
 
 	vk::CommandBufferBeginInfo beginInfo = {};
 
@@ -357,6 +779,13 @@ void Engine::record_draw_commands(vk::CommandBuffer commandBuffer, uint32_t imag
 		vkLogging::Logger::get_logger()->print("Failed to begin recording command buffer!");
 	}
 
+	//take ownership of anything the transfer queue has finished uploading
+	transfer->acquire(commandBuffer, waitSemaphores, waitValues, waitStages);
+
+	if (gpuCulling) {
+		record_culling(commandBuffer, frameContexts[frameNumber]);
+	}
+
 	vk::RenderPassBeginInfo renderPassInfo = {};
 	renderPassInfo.renderPass = renderpass;
 	renderPassInfo.framebuffer = swapchainFrames[imageIndex].framebuffer;
@@ -376,27 +805,28 @@ void Engine::record_draw_commands(vk::CommandBuffer commandBuffer, uint32_t imag
 	commandBuffer.beginRenderPass(&renderPassInfo, vk::SubpassContents::eInline);
 
 	commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
-
-	commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipelineLayout, 0, swapchainFrames[imageIndex].descriptorSet, nullptr);
+	//dynamic in the pipeline, so the current extent is used even right after a resize
+	commandBuffer.setViewport(0, vkInit::make_viewport(swapchainExtent));
+	commandBuffer.setScissor(0, vkInit::make_scissor(swapchainExtent));
+
+	vkUtil::FrameContext& frame = frameContexts[frameNumber];
+	uint32_t dynamicOffsets[] = {
+		static_cast<uint32_t>(frame.cameraDataOffset),
+		static_cast<uint32_t>(frame.modelBufferOffset),
+		static_cast<uint32_t>(frame.visibleBufferOffset),
+		static_cast<uint32_t>(frame.drawCommandsOffset)
+	};
+	commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipelineLayout, 0, frame.descriptorSet, dynamicOffsets);
+	commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipelineLayout, 1, materialDescriptorSet, nullptr);
 
 
 	prepare_scene(commandBuffer);
 
-	uint32_t startInstance = 0;
-
-	// Triangles
-	uint32_t instanceCount = static_cast<uint32_t>(scene->trianglePositions.size());
-	render_objects(commandBuffer, meshTypes::TRIANGLE, startInstance, instanceCount);
-
-
-	// Squares
-	instanceCount = static_cast<uint32_t>(scene->squarePositions.size());
-	render_objects(commandBuffer, meshTypes::SQUARE, startInstance, instanceCount);
-
-
-	// Stars
-	instanceCount = static_cast<uint32_t>(scene->starPositions.size());
-	render_objects(commandBuffer, meshTypes::STAR, startInstance, instanceCount);
+	//materials come from the draw commands, so draws only need splitting up when the device limits them
+	uint32_t drawCount = static_cast<uint32_t>(frame.drawRanges.size());
+	for (uint32_t first = 0; first < drawCount; first += maxDrawsPerCall) {
+		render_objects(commandBuffer, frame, first, std::min(maxDrawsPerCall, drawCount - first));
+	}
 
 	commandBuffer.endRenderPass();
 
@@ -409,27 +839,65 @@ void Engine::record_draw_commands(vk::CommandBuffer commandBuffer, uint32_t imag
 	}
 }
 
-void Engine::render_objects(vk::CommandBuffer commandBuffer, meshTypes objectType, uint32_t& startInstance, uint32_t instanceCount)
+void Engine::record_culling(vk::CommandBuffer commandBuffer, const vkUtil::FrameContext& frame)
 {
-	int indexCount = meshes->indexCounts.find(objectType)->second;
-	int firstIndex = meshes->firstIndices.find(objectType)->second;
-	materials[objectType]->use(commandBuffer, pipelineLayout);
+	uint32_t instanceCount = static_cast<uint32_t>(frame.transformCount);
+	if (instanceCount == 0 || frame.drawRanges.empty()) {
+		return;
+	}
 
-	commandBuffer.drawIndexed(indexCount, instanceCount, firstIndex, 0, startInstance);
-	startInstance += instanceCount;
+	commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, cullPipeline);
+
+	uint32_t dynamicOffsets[] = {
+		static_cast<uint32_t>(frame.cullParamsOffset),
+		static_cast<uint32_t>(frame.modelBufferOffset),
+		static_cast<uint32_t>(frame.visibleBufferOffset),
+		static_cast<uint32_t>(frame.drawCommandsOffset)
+	};
+	commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, cullPipelineLayout, 0, frame.cullDescriptorSet, dynamicOffsets);
+
+	//one invocation per instance, matching local_size_x in cull.comp
+	commandBuffer.dispatch((instanceCount + 63) / 64, 1, 1);
+
+	//the draws read the counts as commands and the visible list as instance indices
+	vk::MemoryBarrier barrier;
+	barrier.srcAccessMask = vk::AccessFlagBits::eShaderWrite;
+	barrier.dstAccessMask = vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eShaderRead;
+	commandBuffer.pipelineBarrier(
+		vk::PipelineStageFlagBits::eComputeShader,
+		vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexShader,
+		vk::DependencyFlags(), barrier, nullptr, nullptr
+	);
+}
+
+void Engine::render_objects(vk::CommandBuffer commandBuffer, const vkUtil::FrameContext& frame, uint32_t firstDraw, uint32_t drawCount)
+{
+	commandBuffer.pushConstants(pipelineLayout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(uint32_t), &firstDraw);
+
+	commandBuffer.drawIndexedIndirect(frame.arena->buffer.buffer,
+		frame.drawCommandsOffset + firstDraw * sizeof(vkUtil::DrawCommand), drawCount, sizeof(vkUtil::DrawCommand));
 }
 
 void Engine::render(Scene* scene) {
 
-	device.waitForFences(1, &(swapchainFrames[frameNumber].inFlight), VK_TRUE, UINT64_MAX);
-	device.resetFences(1, &(swapchainFrames[frameNumber].inFlight));
+	vkUtil::FrameContext& frame = frameContexts[frameNumber];
+
+	//wait until the GPU is done with the frame this context last recorded
+	vk::SemaphoreWaitInfo waitInfo = {};
+	waitInfo.semaphoreCount = 1;
+	waitInfo.pSemaphores = &frameTimeline;
+	waitInfo.pValues = &frame.submission;
+	device.waitSemaphores(waitInfo, UINT64_MAX);
+
+	framesCompleted = device.getSemaphoreCounterValue(frameTimeline);
+	deletionQueue->flush(framesCompleted);
 
 	//acquireNextImageKHR(vk::SwapChainKHR, timeout, semaphore_to_signal, fence)
 	uint32_t imageIndex;
 	try {
 		vk::ResultValue acquire = device.acquireNextImageKHR(
 			swapchain, UINT64_MAX, 
-			swapchainFrames[frameNumber].imageAvailable, nullptr
+			frame.imageAvailable, nullptr
 		);
 		imageIndex = acquire.value;
 	}
@@ -447,31 +915,45 @@ void Engine::render(Scene* scene) {
 		std::cout << "Failed to acquire swapchain image!" << std::endl;
 	}
 
-	vk::CommandBuffer commandBuffer = swapchainFrames[frameNumber].commandBuffer;
+	vk::CommandBuffer commandBuffer = frame.commandBuffer;
 
 	commandBuffer.reset();
 
-	prepare_frame(imageIndex, scene);
+	prepare_frame(scene);
+
+	//values are only read for timeline semaphores
+	std::vector<vk::Semaphore> waitSemaphores = { frame.imageAvailable };
+	std::vector<uint64_t> waitValues = { 0 };
+	std::vector<vk::PipelineStageFlags> waitStages = { vk::PipelineStageFlagBits::eColorAttachmentOutput };
 
-	record_draw_commands(commandBuffer, imageIndex, scene);
+	record_draw_commands(commandBuffer, imageIndex, scene, waitSemaphores, waitValues, waitStages);
+
+	//presentation waits on the binary semaphore, the timeline marks the frame done
+	vk::Semaphore signalSemaphores[] = { swapchainFrames[imageIndex].renderFinished, frameTimeline };
+	uint64_t signalValues[] = { 0, framesSubmitted + 1 };
+
+	vk::TimelineSemaphoreSubmitInfo timelineInfo = {};
+	timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size());
+	timelineInfo.pWaitSemaphoreValues = waitValues.data();
+	timelineInfo.signalSemaphoreValueCount = 2;
+	timelineInfo.pSignalSemaphoreValues = signalValues;
 
 	vk::SubmitInfo submitInfo = {};
+	submitInfo.pNext = &timelineInfo;
 
-	vk::Semaphore waitSemaphores[] = { swapchainFrames[frameNumber].imageAvailable };
-	vk::PipelineStageFlags waitStages[] = { vk::PipelineStageFlagBits::eColorAttachmentOutput };
-	submitInfo.waitSemaphoreCount = 1;
-	submitInfo.pWaitSemaphores = waitSemaphores;
-	submitInfo.pWaitDstStageMask = waitStages;
+	submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+	submitInfo.pWaitSemaphores = waitSemaphores.data();
+	submitInfo.pWaitDstStageMask = waitStages.data();
 
 	submitInfo.commandBufferCount = 1;
 	submitInfo.pCommandBuffers = &commandBuffer;
 
-	vk::Semaphore signalSemaphores[] = { swapchainFrames[frameNumber].renderFinished };
-	submitInfo.signalSemaphoreCount = 1;
+	submitInfo.signalSemaphoreCount = 2;
 	submitInfo.pSignalSemaphores = signalSemaphores;
 
 	try {
-		graphicsQueue.submit(submitInfo, swapchainFrames[frameNumber].inFlight);
+		graphicsQueue.submit(submitInfo, nullptr);
+		frame.submission = ++framesSubmitted;
 	}
 	catch (vk::SystemError err) {
 		vkLogging::Logger::get_logger()->print("failed to submit draw command buffer!");
@@ -487,6 +969,16 @@ void Engine::render(Scene* scene) {
 
 	presentInfo.pImageIndices = &imageIndex;
 
+	//the fence was last given to this context's previous present, which has usually finished by now
+	vk::SwapchainPresentFenceInfoEXT presentFenceInfo = {};
+	if (presentFences) {
+		device.waitForFences(frame.presentFence, VK_TRUE, UINT64_MAX);
+		device.resetFences(frame.presentFence);
+		presentFenceInfo.swapchainCount = 1;
+		presentFenceInfo.pFences = &frame.presentFence;
+		presentInfo.pNext = &presentFenceInfo;
+	}
+
 	vk::Result present;
 
 	try {
@@ -516,8 +1008,6 @@ void Engine::cleanup_swapchain() {
 	}
 	device.destroySwapchainKHR(swapchain);
 
-	device.destroyDescriptorPool(frameDescriptorPool);
-
 }
 
 Engine::~Engine() {
@@ -526,26 +1016,51 @@ Engine::~Engine() {
 
 	vkLogging::Logger::get_logger()->print("Goodbye see you!");
 
+	//everything has finished, so whatever is still queued can go
+	delete deletionQueue;
+
+	delete transfer;
+	device.destroyCommandPool(transferCommandPool);
 	device.destroyCommandPool(commandPool);
 
 	device.destroyPipeline(pipeline);
 	device.destroyPipelineLayout(pipelineLayout);
+	if (gpuCulling) {
+		device.destroyPipeline(cullPipeline);
+		device.destroyPipelineLayout(cullPipelineLayout);
+	}
 	device.destroyRenderPass(renderpass);
 
 	cleanup_swapchain();
 
+	for (vkUtil::FrameContext& frame : frameContexts) {
+		frame.destroy();
+	}
+	device.destroySemaphore(frameTimeline);
+	device.destroyDescriptorPool(frameDescriptorPool);
 	device.destroyDescriptorSetLayout(frameDescriptorSetLayout);
+	if (gpuCulling) {
+		device.destroyDescriptorSetLayout(cullDescriptorSetLayout);
+	}
 
 
 	delete meshes;
+	delete threadPool;
 
-	for (const auto& [key, texture] : materials) {
+	for (vkImage::Texture* texture : materials) {
 		delete texture;
 	}
+	delete fallbackTexture;
 	
 	device.destroyDescriptorSetLayout(meshDescriptorSetLayout);
 	device.destroyDescriptorPool(meshDescriptorPool);
 
+	delete stagingRing;
+	delete allocator;
+
+	pipelineCache->save();
+	delete pipelineCache;
+
 	device.destroy();
 
 	instance.destroySurfaceKHR(surface);
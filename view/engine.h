@@ -3,18 +3,38 @@
 #include "vkUtil/frame.h"
 #include "../model/scene.h"
 #include "../model/vertex_menagerie.h"
+#include "../model/registry.h"
 #include "vkImage/image.h"
+#include "vkUtil/transfer.h"
+#include "vkUtil/culling.h"
+#include "vkUtil/pipeline_cache.h"
+#include "vkUtil/deletion_queue.h"
+#include "../control/thread_pool.h"
 
 class Engine {
 
 public:
 
-	Engine(int width, int height, GLFWwindow* window);
+	/**
+		\param registry the registry meshes and materials are loaded into
+		\param framesInFlight how many frames the CPU may record ahead of the GPU,
+			more smooths out stalls at the cost of latency
+	*/
+	Engine(int width, int height, GLFWwindow* window, AssetRegistry* registry, int framesInFlight = 2);
 
 	~Engine();
 
 	void render(Scene* scene);
 
+	/**
+		Release a material once the frames already submitted are done with it.
+		Scenes must stop drawing with it first, its slot is left unbound until
+		a material is loaded into it again.
+
+		\param material the material's handle
+	*/
+	void release_material(uint32_t material);
+
 private:
 
 	//glfw-related variables
@@ -33,40 +53,84 @@ private:
 	vk::Device device{ nullptr };
 	vk::Queue graphicsQueue{ nullptr };
 	vk::Queue presentQueue{ nullptr };
+	vk::Queue transferQueue{ nullptr };
+	//whether presents signal a fence when done, through VK_EXT_swapchain_maintenance1
+	bool presentFences;
+	vkUtil::MemoryAllocator* allocator;
+	//resources dropped while frames may still use them, keyed by the frame timeline
+	vkUtil::DeletionQueue* deletionQueue;
 	vk::SwapchainKHR swapchain{ nullptr };
 	std::vector<vkUtil::SwapChainFrame> swapchainFrames;
 	vk::Format swapchainFormat;
 	vk::Extent2D swapchainExtent;
+	//chosen once, every swapchain's depth buffers use it
+	vk::Format depthFormat;
+
 
 	//pipeline-related variables
+	vkUtil::PipelineCache* pipelineCache;
 	vk::PipelineLayout pipelineLayout;
 	vk::RenderPass renderpass;
 	vk::Pipeline pipeline;
 
+	//culling pipeline, made if the graphics queue can run compute work
+	bool gpuCulling;
+	vk::PipelineLayout cullPipelineLayout;
+	vk::Pipeline cullPipeline;
+
+	//how many draws one indirect call may issue, 1 without multiDrawIndirect
+	uint32_t maxDrawsPerCall;
+
 	//Command-related variables
 	vk::CommandPool commandPool;
-	vk::CommandBuffer mainCommandBuffer;
+	vk::CommandPool transferCommandPool;
 
-	//Synchronization objects
+	//Frame contexts, used round robin
+	std::vector<vkUtil::FrameContext> frameContexts;
 	int maxFramesInFlight, frameNumber;
+	//every frame's submission signals its number here, which tells what the GPU is done with
+	vk::Semaphore frameTimeline;
+	//frames submitted so far, and the latest one known to have completed
+	uint64_t framesSubmitted, framesCompleted;
 
 	// Descriptor objects
 	vk::DescriptorSetLayout frameDescriptorSetLayout;
 	vk::DescriptorPool frameDescriptorPool;
+	vk::DescriptorSetLayout cullDescriptorSetLayout;
 
+	//the bindless material array
 	vk::DescriptorSetLayout meshDescriptorSetLayout;
 	vk::DescriptorPool meshDescriptorPool;
+	vk::DescriptorSet materialDescriptorSet;
+	uint32_t materialCapacity;
 
 	//asset pointers
+	vkUtil::StagingRing* stagingRing;
+	vkUtil::TransferContext* transfer;
+	AssetRegistry* registry;
 	VertexMenagerie* meshes;
-	std::unordered_map<meshTypes, vkImage::Texture*> materials;
+	//indexed by material handle
+	std::vector<vkImage::Texture*> materials;
+	//drawn in place of materials which failed to load
+	vkImage::Texture* fallbackTexture;
+
+	//culling
+	struct CullChunk {
+		uint32_t group;
+		uint32_t first;
+		uint32_t count;
+		uint32_t visibleCount;
+	};
+	ThreadPool* threadPool;
+	std::vector<CullChunk> cullChunks;
+	std::vector<uint32_t> cullScratch;
 
 	//instance setup
 	void make_instance();
 
 	//device setup
 	void make_device();
-	void make_swapchain();
+	void make_swapchain(vk::SwapchainKHR oldSwapchain = nullptr);
 	void recreate_swapchain();
 
 	//pipeline setup
@@ -76,15 +140,20 @@ private:
 	//final setup steps
 	void finalize_setup();
 	void make_framebuffers();
-	void make_frame_resources();
+	void make_frame_contexts();
 
 	//asset creation
 	void make_assets();
 
 	void prepare_scene(vk::CommandBuffer commandBuffer);
-	void prepare_frame(uint32_t imageIndex, Scene* scene);
-	void record_draw_commands(vk::CommandBuffer commandBuffer, uint32_t imageIndex, Scene* scene);
-	void render_objects(vk::CommandBuffer commandBuffer, meshTypes objectType, uint32_t& startInstance, uint32_t instanceCount);
+	void prepare_frame(Scene* scene);
+	void write_cull_params(Scene* scene, const vkUtil::Frustum& frustum, vkUtil::FrameContext& frame);
+	void write_draw_commands(vkUtil::FrameContext& frame);
+	void cull_instances(Scene* scene, const vkUtil::Frustum& frustum, uint32_t* visible, vkUtil::FrameContext& frame);
+	void record_draw_commands(vk::CommandBuffer commandBuffer, uint32_t imageIndex, Scene* scene,
+		std::vector<vk::Semaphore>& waitSemaphores, std::vector<uint64_t>& waitValues, std::vector<vk::PipelineStageFlags>& waitStages);
+	void record_culling(vk::CommandBuffer commandBuffer, const vkUtil::FrameContext& frame);
+	void render_objects(vk::CommandBuffer commandBuffer, const vkUtil::FrameContext& frame, uint32_t firstDraw, uint32_t drawCount);
 
 	//Cleanup functions
 	void cleanup_swapchain();
@@ -0,0 +1,431 @@
+#include "blocks.h"
+#include <algorithm>
+
+namespace {
+
+	/*
+	* BC7 tables, from the BC7 format specification.
+	* For two subsets bit i says which subset texel i belongs to.
+	*/
+	const uint16_t partitions2[64] = {
+		0xcccc, 0x8888, 0xeeee, 0xecc8, 0xc880, 0xfeec, 0xfec8, 0xec80,
+		0xc800, 0xffec, 0xfe80, 0xe800, 0xffe8, 0xff00, 0xfff0, 0xf000,
+		0xf710, 0x008e, 0x7100, 0x08ce, 0x008c, 0x7310, 0x3100, 0x8cce,
+		0x088c, 0x3110, 0x6666, 0x366c, 0x17e8, 0x0ff0, 0x718e, 0x399c,
+		0xaaaa, 0xf0f0, 0x5a5a, 0x33cc, 0x3c3c, 0x55aa, 0x9696, 0xa55a,
+		0x73ce, 0x13c8, 0x324c, 0x3bdc, 0x6996, 0xc33c, 0x9966, 0x0660,
+		0x0272, 0x04e4, 0x4e40, 0x2720, 0xc936, 0x936c, 0x39c6, 0x639c,
+		0x9336, 0x9cc6, 0x817e, 0xe718, 0xccf0, 0x0fcc, 0x7744, 0xee22,
+	};
+
+	const uint8_t partitions3[64][16] = {
+		{ 0, 0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 1, 2, 2, 2, 2 },
+		{ 0, 0, 0, 1, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 2, 1 },
+		{ 0, 0, 0, 0, 2, 0, 0, 1, 2, 2, 1, 1, 2, 2, 1, 1 },
+		{ 0, 2, 2, 2, 0, 0, 2, 2, 0, 0, 1, 1, 0, 1, 1, 1 },
+		{ 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2 },
+		{ 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 2, 2, 0, 0, 2, 2 },
+		{ 0, 0, 2, 2, 0, 0, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1 },
+		{ 0, 0, 1, 1, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1 },
+		{ 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2 },
+		{ 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2 },
+		{ 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2 },
+		{ 0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2 },
+		{ 0, 1, 1, 2, 0, 1, 1, 2, 0, 1, 1, 2, 0, 1, 1, 2 },
+		{ 0, 1, 2, 2, 0, 1, 2, 2, 0, 1, 2, 2, 0, 1, 2, 2 },
+		{ 0, 0, 1, 1, 0, 1, 1, 2, 1, 1, 2, 2, 1, 2, 2, 2 },
+		{ 0, 0, 1, 1, 2, 0, 0, 1, 2, 2, 0, 0, 2, 2, 2, 0 },
+		{ 0, 0, 0, 1, 0, 0, 1, 1, 0, 1, 1, 2, 1, 1, 2, 2 },
+		{ 0, 1, 1, 1, 0, 0, 1, 1, 2, 0, 0, 1, 2, 2, 0, 0 },
+		{ 0, 0, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1, 2, 2 },
+		{ 0, 0, 2, 2, 0, 0, 2, 2, 0, 0, 2, 2, 1, 1, 1, 1 },
+		{ 0, 1, 1, 1, 0, 1, 1, 1, 0, 2, 2, 2, 0, 2, 2, 2 },
+		{ 0, 0, 0, 1, 0, 0, 0, 1, 2, 2, 2, 1, 2, 2, 2, 1 },
+		{ 0, 0, 0, 0, 0, 0, 1, 1, 0, 1, 2, 2, 0, 1, 2, 2 },
+		{ 0, 0, 0, 0, 1, 1, 0, 0, 2, 2, 1, 0, 2, 2, 1, 0 },
+		{ 0, 1, 2, 2, 0, 1, 2, 2, 0, 0, 1, 1, 0, 0, 0, 0 },
+		{ 0, 0, 1, 2, 0, 0, 1, 2, 1, 1, 2, 2, 2, 2, 2, 2 },
+		{ 0, 1, 1, 0, 1, 2, 2, 1, 1, 2, 2, 1, 0, 1, 1, 0 },
+		{ 0, 0, 0, 0, 0, 1, 1, 0, 1, 2, 2, 1, 1, 2, 2, 1 },
+		{ 0, 0, 2, 2, 1, 1, 0, 2, 1, 1, 0, 2, 0, 0, 2, 2 },
+		{ 0, 1, 1, 0, 0, 1, 1, 0, 2, 0, 0, 2, 2, 2, 2, 2 },
+		{ 0, 0, 1, 1, 0, 1, 2, 2, 0, 1, 2, 2, 0, 0, 1, 1 },
+		{ 0, 0, 0, 0, 2, 0, 0, 0, 2, 2, 1, 1, 2, 2, 2, 1 },
+		{ 0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 2, 2, 2 },
+		{ 0, 2, 2, 2, 0, 0, 2, 2, 0, 0, 1, 2, 0, 0, 1, 1 },
+		{ 0, 0, 1, 1, 0, 0, 1, 2, 0, 0, 2, 2, 0, 2, 2, 2 },
+		{ 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0 },
+		{ 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 0, 0, 0, 0 },
+		{ 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0 },
+		{ 0, 1, 2, 0, 2, 0, 1, 2, 1, 2, 0, 1, 0, 1, 2, 0 },
+		{ 0, 0, 1, 1, 2, 2, 0, 0, 1, 1, 2, 2, 0, 0, 1, 1 },
+		{ 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 0, 0, 0, 0, 1, 1 },
+		{ 0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2 },
+		{ 0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 2, 1, 2, 1, 2, 1 },
+		{ 0, 0, 2, 2, 1, 1, 2, 2, 0, 0, 2, 2, 1, 1, 2, 2 },
+		{ 0, 0, 2, 2, 0, 0, 1, 1, 0, 0, 2, 2, 0, 0, 1, 1 },
+		{ 0, 2, 2, 0, 1, 2, 2, 1, 0, 2, 2, 0, 1, 2, 2, 1 },
+		{ 0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2, 0, 1, 0, 1 },
+		{ 0, 0, 0, 0, 2, 1, 2, 1, 2, 1, 2, 1, 2, 1, 2, 1 },
+		{ 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2 },
+		{ 0, 2, 2, 2, 0, 1, 1, 1, 0, 2, 2, 2, 0, 1, 1, 1 },
+		{ 0, 0, 0, 2, 1, 1, 1, 2, 0, 0, 0, 2, 1, 1, 1, 2 },
+		{ 0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1, 2 },
+		{ 0, 2, 2, 2, 0, 1, 1, 1, 0, 1, 1, 1, 0, 2, 2, 2 },
+		{ 0, 0, 0, 2, 1, 1, 1, 2, 1, 1, 1, 2, 0, 0, 0, 2 },
+		{ 0, 1, 1, 0, 0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 2, 2 },
+		{ 0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 1, 2 },
+		{ 0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 2, 2, 2, 2, 2, 2 },
+		{ 0, 0, 2, 2, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 2, 2 },
+		{ 0, 0, 2, 2, 1, 1, 2, 2, 1, 1, 2, 2, 0, 0, 2, 2 },
+		{ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2 },
+		{ 0, 0, 0, 2, 0, 0, 0, 1, 0, 0, 0, 2, 0, 0, 0, 1 },
+		{ 0, 2, 2, 2, 1, 2, 2, 2, 0, 2, 2, 2, 1, 2, 2, 2 },
+		{ 0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2 },
+		{ 0, 1, 1, 1, 2, 0, 1, 1, 2, 2, 0, 1, 2, 2, 2, 0 },
+	};
+
+	//the texel of each subset (after the first, whose anchor is texel 0) whose index drops its top bit
+	const uint8_t anchors2[64] = {
+		15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+		15, 2, 8, 2, 2, 8, 8, 15, 2, 8, 2, 2, 8, 8, 2, 2,
+		15, 15, 6, 8, 2, 8, 15, 15, 2, 8, 2, 2, 2, 15, 15, 6,
+		6, 2, 6, 8, 15, 15, 2, 2, 15, 15, 15, 15, 15, 2, 2, 15,
+	};
+
+	const uint8_t anchors3a[64] = {
+		3, 3, 15, 15, 8, 3, 15, 15, 8, 8, 6, 6, 6, 5, 3, 3,
+		3, 3, 8, 15, 3, 3, 6, 10, 5, 8, 8, 6, 8, 5, 15, 15,
+		8, 15, 3, 5, 6, 10, 8, 15, 15, 3, 15, 5, 15, 15, 15, 15,
+		3, 15, 5, 5, 5, 8, 5, 10, 5, 10, 8, 13, 15, 12, 3, 3,
+	};
+
+	const uint8_t anchors3b[64] = {
+		15, 8, 8, 3, 15, 15, 3, 8, 15, 15, 15, 15, 15, 15, 15, 8,
+		15, 8, 15, 3, 15, 8, 15, 8, 3, 15, 6, 10, 15, 15, 10, 8,
+		15, 3, 15, 10, 10, 8, 9, 10, 6, 15, 8, 15, 3, 6, 6, 8,
+		15, 3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 3, 15, 15, 8,
+	};
+
+	//interpolation weights out of 64, by index size
+	const uint8_t weights2[4] = { 0, 21, 43, 64 };
+	const uint8_t weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+	const uint8_t weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	struct Bc7Mode {
+		uint32_t subsets, partitionBits, rotationBits, indexSelectionBits;
+		uint32_t colorBits, alphaBits, endpointPBits, sharedPBits;
+		uint32_t indexBits, secondaryIndexBits;
+	};
+
+	const Bc7Mode bc7Modes[8] = {
+		{ 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+		{ 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+		{ 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+		{ 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+		{ 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+		{ 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+		{ 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+		{ 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 }
+	};
+
+	/*
+	* Reads a block's fields in order, starting from
+	* the least significant bit of its first byte.
+	*/
+	struct BitReader {
+		const unsigned char* block;
+		uint32_t position;
+
+		uint32_t read(uint32_t count) {
+			uint32_t value = 0;
+			for (uint32_t i = 0; i < count; ++i, ++position) {
+				value |= ((block[position >> 3] >> (position & 7)) & 1u) << i;
+			}
+			return value;
+		}
+	};
+
+	uint32_t interpolate(uint32_t e0, uint32_t e1, uint32_t weight) {
+		return ((64 - weight) * e0 + weight * e1 + 32) >> 6;
+	}
+
+	const uint8_t* bc7_weights(uint32_t indexBits) {
+		return indexBits == 2 ? weights2 : (indexBits == 3 ? weights3 : weights4);
+	}
+
+	//widen an endpoint to 8 bits, repeating its top bits in the bits below
+	uint32_t expand(uint32_t value, uint32_t bits) {
+		value <<= 8 - bits;
+		return value | (value >> bits);
+	}
+
+	/*
+	* A BC1 colour block, also the colour half of BC3. With threeColor set
+	* c0 <= c1 picks a palette of three colours and (transparent) black.
+	*/
+	void decode_color_block(const unsigned char* block, bool threeColor, bool transparentBlack, unsigned char* texels) {
+
+		uint32_t c[2];
+		c[0] = block[0] | (block[1] << 8u);
+		c[1] = block[2] | (block[3] << 8u);
+
+		uint32_t palette[4][4];
+		for (int i = 0; i < 2; ++i) {
+			palette[i][0] = expand((c[i] >> 11) & 31, 5);
+			palette[i][1] = expand((c[i] >> 5) & 63, 6);
+			palette[i][2] = expand(c[i] & 31, 5);
+			palette[i][3] = 255;
+		}
+
+		bool fourColor = !threeColor || c[0] > c[1];
+		for (int channel = 0; channel < 3; ++channel) {
+			uint32_t e0 = palette[0][channel];
+			uint32_t e1 = palette[1][channel];
+			palette[2][channel] = fourColor ? (2 * e0 + e1) / 3 : (e0 + e1) / 2;
+			palette[3][channel] = fourColor ? (e0 + 2 * e1) / 3 : 0;
+		}
+		palette[2][3] = 255;
+		palette[3][3] = (fourColor || !transparentBlack) ? 255 : 0;
+
+		uint32_t indices = block[4] | (block[5] << 8u) | (block[6] << 16u) | (static_cast<uint32_t>(block[7]) << 24u);
+		for (int i = 0; i < 16; ++i) {
+			uint32_t* color = palette[(indices >> (2 * i)) & 3];
+			for (int channel = 0; channel < 4; ++channel) {
+				texels[4 * i + channel] = static_cast<unsigned char>(color[channel]);
+			}
+		}
+	}
+
+	//a BC4 block, one channel of eight interpolated values, as in BC3 alpha and both halves of BC5
+	void decode_channel_block(const unsigned char* block, int channel, unsigned char* texels) {
+
+		uint32_t values[8];
+		values[0] = block[0];
+		values[1] = block[1];
+		if (values[0] > values[1]) {
+			for (uint32_t i = 1; i < 7; ++i) {
+				values[i + 1] = ((7 - i) * values[0] + i * values[1]) / 7;
+			}
+		}
+		else {
+			for (uint32_t i = 1; i < 5; ++i) {
+				values[i + 1] = ((5 - i) * values[0] + i * values[1]) / 5;
+			}
+			values[6] = 0;
+			values[7] = 255;
+		}
+
+		uint64_t indices = 0;
+		for (int i = 0; i < 6; ++i) {
+			indices |= static_cast<uint64_t>(block[2 + i]) << (8 * i);
+		}
+		for (int i = 0; i < 16; ++i) {
+			texels[4 * i + channel] = static_cast<unsigned char>(values[(indices >> (3 * i)) & 7]);
+		}
+	}
+
+	void decode_bc7_block(const unsigned char* block, unsigned char* texels) {
+
+		//the mode is the position of the lowest set bit
+		uint32_t mode = 0;
+		while (mode < 8 && !(block[0] & (1u << mode))) {
+			++mode;
+		}
+		if (mode == 8) {
+			std::fill(texels, texels + 64, static_cast<unsigned char>(0));
+			return;
+		}
+		const Bc7Mode& info = bc7Modes[mode];
+		BitReader bits{ block, mode + 1 };
+
+		uint32_t partition = bits.read(info.partitionBits);
+		uint32_t rotation = bits.read(info.rotationBits);
+		uint32_t indexSelection = bits.read(info.indexSelectionBits);
+
+		//two endpoints per subset, stored channel by channel
+		uint32_t endpoints[6][4];
+		uint32_t endpointCount = 2 * info.subsets;
+		for (uint32_t channel = 0; channel < 3; ++channel) {
+			for (uint32_t i = 0; i < endpointCount; ++i) {
+				endpoints[i][channel] = bits.read(info.colorBits);
+			}
+		}
+		for (uint32_t i = 0; i < endpointCount; ++i) {
+			endpoints[i][3] = info.alphaBits ? bits.read(info.alphaBits) : 255;
+		}
+
+		//p-bits add a shared lowest bit to every channel of an endpoint
+		uint32_t pBitCount = 0;
+		if (info.endpointPBits || info.sharedPBits) {
+			pBitCount = 1;
+			uint32_t pBits[6];
+			for (uint32_t i = 0; i < endpointCount; ++i) {
+				pBits[i] = (info.endpointPBits || i % 2 == 0) ? bits.read(1) : pBits[i - 1];
+			}
+			for (uint32_t i = 0; i < endpointCount; ++i) {
+				for (uint32_t channel = 0; channel < (info.alphaBits ? 4u : 3u); ++channel) {
+					endpoints[i][channel] = (endpoints[i][channel] << 1) | pBits[i];
+				}
+			}
+		}
+		for (uint32_t i = 0; i < endpointCount; ++i) {
+			for (uint32_t channel = 0; channel < 3; ++channel) {
+				endpoints[i][channel] = expand(endpoints[i][channel], info.colorBits + pBitCount);
+			}
+			if (info.alphaBits) {
+				endpoints[i][3] = expand(endpoints[i][3], info.alphaBits + pBitCount);
+			}
+		}
+
+		uint32_t subsets[16];
+		for (int i = 0; i < 16; ++i) {
+			subsets[i] = info.subsets == 1 ? 0
+				: (info.subsets == 2 ? (partitions2[partition] >> i) & 1 : partitions3[partition][i]);
+		}
+
+		//an anchor's index is one bit short, its top bit is always 0
+		uint32_t indices[16], secondaryIndices[16];
+		for (uint32_t i = 0; i < 16; ++i) {
+			bool anchor = i == 0
+				|| (info.subsets == 2 && i == anchors2[partition])
+				|| (info.subsets == 3 && (i == anchors3a[partition] || i == anchors3b[partition]));
+			indices[i] = bits.read(info.indexBits - (anchor ? 1 : 0));
+		}
+		if (info.secondaryIndexBits) {
+			for (uint32_t i = 0; i < 16; ++i) {
+				secondaryIndices[i] = bits.read(info.secondaryIndexBits - (i == 0 ? 1 : 0));
+			}
+		}
+
+		//with two sets of indices, one is for colour and the other alpha
+		const uint32_t* colorIndices = indices;
+		const uint32_t* alphaIndices = indices;
+		const uint8_t* colorWeights = bc7_weights(info.indexBits);
+		const uint8_t* alphaWeights = colorWeights;
+		if (info.secondaryIndexBits) {
+			const uint8_t* primaryWeights = colorWeights;
+			const uint8_t* secondaryWeights = bc7_weights(info.secondaryIndexBits);
+			colorIndices = indexSelection ? secondaryIndices : indices;
+			alphaIndices = indexSelection ? indices : secondaryIndices;
+			colorWeights = indexSelection ? secondaryWeights : primaryWeights;
+			alphaWeights = indexSelection ? primaryWeights : secondaryWeights;
+		}
+
+		for (int i = 0; i < 16; ++i) {
+			const uint32_t* e0 = endpoints[2 * subsets[i]];
+			const uint32_t* e1 = endpoints[2 * subsets[i] + 1];
+			uint32_t texel[4];
+			for (int channel = 0; channel < 3; ++channel) {
+				texel[channel] = interpolate(e0[channel], e1[channel], colorWeights[colorIndices[i]]);
+			}
+			texel[3] = interpolate(e0[3], e1[3], alphaWeights[alphaIndices[i]]);
+
+			//rotation swaps alpha with one of the colour channels
+			if (rotation) {
+				std::swap(texel[3], texel[rotation - 1]);
+			}
+			for (int channel = 0; channel < 4; ++channel) {
+				texels[4 * i + channel] = static_cast<unsigned char>(texel[channel]);
+			}
+		}
+	}
+
+	size_t block_bytes(vk::Format format) {
+		switch (format) {
+		case vk::Format::eBc1RgbUnormBlock:
+		case vk::Format::eBc1RgbSrgbBlock:
+		case vk::Format::eBc1RgbaUnormBlock:
+		case vk::Format::eBc1RgbaSrgbBlock:
+			return 8;
+		default:
+			return 16;
+		}
+	}
+}
+
+bool vkImage::is_block_compressed(vk::Format format)
+{
+	switch (format) {
+	case vk::Format::eBc1RgbUnormBlock:
+	case vk::Format::eBc1RgbSrgbBlock:
+	case vk::Format::eBc1RgbaUnormBlock:
+	case vk::Format::eBc1RgbaSrgbBlock:
+	case vk::Format::eBc3UnormBlock:
+	case vk::Format::eBc3SrgbBlock:
+	case vk::Format::eBc5UnormBlock:
+	case vk::Format::eBc7UnormBlock:
+	case vk::Format::eBc7SrgbBlock:
+		return true;
+	default:
+		return false;
+	}
+}
+
+vk::Format vkImage::decoded_format(vk::Format format)
+{
+	switch (format) {
+	case vk::Format::eBc1RgbSrgbBlock:
+	case vk::Format::eBc1RgbaSrgbBlock:
+	case vk::Format::eBc3SrgbBlock:
+	case vk::Format::eBc7SrgbBlock:
+		return vk::Format::eR8G8B8A8Srgb;
+	default:
+		return vk::Format::eR8G8B8A8Unorm;
+	}
+}
+
+size_t vkImage::level_size(vk::Format format, int width, int height)
+{
+	if (!is_block_compressed(format)) {
+		return static_cast<size_t>(width) * height * 4;
+	}
+	return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * block_bytes(format);
+}
+
+void vkImage::decode_blocks(vk::Format format, const unsigned char* src, int width, int height, unsigned char* dst)
+{
+	size_t blockSize = block_bytes(format);
+	unsigned char texels[16 * 4];
+
+	for (int blockY = 0; blockY < height; blockY += 4) {
+		for (int blockX = 0; blockX < width; blockX += 4) {
+
+			switch (format) {
+			case vk::Format::eBc1RgbUnormBlock:
+			case vk::Format::eBc1RgbSrgbBlock:
+				decode_color_block(src, true, false, texels);
+				break;
+			case vk::Format::eBc1RgbaUnormBlock:
+			case vk::Format::eBc1RgbaSrgbBlock:
+				decode_color_block(src, true, true, texels);
+				break;
+			case vk::Format::eBc3UnormBlock:
+			case vk::Format::eBc3SrgbBlock:
+				decode_color_block(src + 8, false, false, texels);
+				decode_channel_block(src, 3, texels);
+				break;
+			case vk::Format::eBc5UnormBlock:
+				for (int i = 0; i < 16; ++i) {
+					texels[4 * i + 2] = 0;
+					texels[4 * i + 3] = 255;
+				}
+				decode_channel_block(src, 0, texels);
+				decode_channel_block(src + 8, 1, texels);
+				break;
+			default:
+				decode_bc7_block(src, texels);
+				break;
+			}
+			src += blockSize;
+
+			//blocks hanging over the right or bottom edge only keep the texels inside the level
+			int rows = std::min(4, height - blockY);
+			int columns = std::min(4, width - blockX);
+			for (int y = 0; y < rows; ++y) {
+				std::copy(texels + 16 * y, texels + 16 * y + 4 * columns,
+					dst + (static_cast<size_t>(blockY + y) * width + blockX) * 4);
+			}
+		}
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "../../config.h"
+
+namespace vkImage {
+
+	/**
+		\param format an image format
+		\returns whether it's one of the block compressed formats textures can be loaded in
+			(BC1, BC3, BC5 or BC7)
+	*/
+	bool is_block_compressed(vk::Format format);
+
+	/**
+		\param format a block compressed format
+		\returns the RGBA8 format its blocks are decoded to when the device can't sample it
+	*/
+	vk::Format decoded_format(vk::Format format);
+
+	/**
+		\param format RGBA8 or a block compressed format
+		\param width the width of the level
+		\param height the height of the level
+		\returns the size (in bytes) of one tightly packed level, partial blocks rounded up
+	*/
+	size_t level_size(vk::Format format, int width, int height);
+
+	/**
+		Decode one level of a block compressed image into RGBA8 on the CPU.
+		Used when the device can't sample the format.
+
+		\param format the block compressed format
+		\param src the level's blocks, tightly packed
+		\param width the width of the level
+		\param height the height of the level
+		\param dst the RGBA8 texels are written here, width * height * 4 bytes
+	*/
+	void decode_blocks(vk::Format format, const unsigned char* src, int width, int height, unsigned char* dst);
+}
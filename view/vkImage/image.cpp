@@ -1,107 +1,468 @@
 #include "image.h"
+#include <algorithm>
+
+namespace {
+
+	/*
+	* stb_image always allocates the buffer it decodes into. While a file is
+	* decoded into staging memory, the allocation the size of the RGBA8 result
+	* is handed the staging region instead, so the pixels land there directly.
+	*/
+	struct DecodeTarget {
+		void* data;
+		size_t size;
+		bool taken;
+	};
+	thread_local DecodeTarget decodeTarget = {};
+
+	void* decode_malloc(size_t size) {
+		//jpegs ask for one byte more than the pixels
+		if (decodeTarget.data && !decodeTarget.taken && size >= decodeTarget.size && size <= decodeTarget.size + 1) {
+			decodeTarget.taken = true;
+			return decodeTarget.data;
+		}
+		return malloc(size);
+	}
+
+	void* decode_realloc(void* block, size_t size) {
+		//a buffer being grown can't stay in the region, move it out
+		if (block && block == decodeTarget.data) {
+			void* moved = malloc(size);
+			if (moved) {
+				memcpy(moved, block, std::min(size, decodeTarget.size));
+			}
+			decodeTarget.taken = false;
+			return moved;
+		}
+		return realloc(block, size);
+	}
+
+	void decode_free(void* block) {
+		if (block && block == decodeTarget.data) {
+			decodeTarget.taken = false;
+			return;
+		}
+		free(block);
+	}
+}
+
+#define STBI_MALLOC(size) decode_malloc(size)
+#define STBI_REALLOC(block, size) decode_realloc(block, size)
+#define STBI_FREE(block) decode_free(block)
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 #include "../vkUtil/memory.h"
+#include "mipmaps.h"
+#include "blocks.h"
+#include "ktx2.h"
 #include "../../control/logging.h"
-#include "../vkInit/descriptors.h"
-#include "../vkUtil/single_time_commands.h"
 
 
 vkImage::Texture::Texture(TextureInputChunk input)
-	: logicalDevice{input.logicalDevice}, physicalDevice{input.physicalDevice}, filename{input.filename},
-	commandBuffer{input.commandBuffer}, queue{input.queue}, layout{input.layout}, descriptorPool{input.descriptorPool}
+	: logicalDevice{input.logicalDevice}, physicalDevice{input.physicalDevice}, allocator{input.allocator},
+	transfer{input.transfer}, descriptorSet{input.descriptorSet}, slot{input.slot}
 {
-	load();
+	staging = input.staging;
+	width = input.decoded.width;
+	height = input.decoded.height;
+	channels = input.decoded.channels;
+	format = input.decoded.format;
+	mipLevels = input.decoded.mipLevels;
+	uploadedLevels = input.decoded.levels;
 
 	ImageInputChunk imageInput;
 	imageInput.logicalDevice = logicalDevice;
 	imageInput.physicalDevice = physicalDevice;
+	imageInput.allocator = allocator;
 	imageInput.height = height;
 	imageInput.width = width;
+	imageInput.mipLevels = mipLevels;
 	imageInput.tiling = vk::ImageTiling::eOptimal;
 	imageInput.usage = vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled;
+	//the rest of the mip chain is blitted from each level to the next
+	if (uploadedLevels < mipLevels) {
+		imageInput.usage |= vk::ImageUsageFlagBits::eTransferSrc;
+	}
 	imageInput.memoryProperties = vk::MemoryPropertyFlagBits::eDeviceLocal;
-	imageInput.format = vk::Format::eR8G8B8A8Unorm;
+	imageInput.format = format;
 
 	image = make_image(imageInput);
 	imageMemory = make_image_memory(imageInput, image);
 
 	populate();
 
-	free(pixels);
-
 	make_view();
 
 	make_sampler();
 
-	make_descriptor_set();
+	write_descriptor(slot);
 }
 
 vkImage::Texture::~Texture()
 {
-	logicalDevice.freeMemory(imageMemory);
 	logicalDevice.destroyImage(image);
+	allocator->free(imageMemory);
 	logicalDevice.destroyImageView(imageView);
 	logicalDevice.destroySampler(sampler);
 }
 
-void vkImage::Texture::use(vk::CommandBuffer commandBuffer, vk::PipelineLayout pipelineLayout)
+void vkImage::Texture::retire(vkUtil::DeletionQueue& deletionQueue, uint64_t lastUse)
+{
+	deletionQueue.push(lastUse, imageView);
+	deletionQueue.push(lastUse, sampler);
+	deletionQueue.push(lastUse, image);
+	deletionQueue.push(lastUse, imageMemory);
+
+	//destroying null handles does nothing, neither does freeing an empty allocation
+	imageView = nullptr;
+	sampler = nullptr;
+	image = nullptr;
+	imageMemory = {};
+}
+
+vkImage::TextureSupport vkImage::query_texture_support(vk::PhysicalDevice physicalDevice)
 {
-	commandBuffer.bindDescriptorSets(
-		vk::PipelineBindPoint::eGraphics, pipelineLayout, 1, descriptorSet, nullptr
+	TextureSupport support;
+
+	//images decode to unorm, KTX2 files may also be sRGB, and support can differ between the two
+	vk::FormatFeatureFlags blitFeatures = vk::FormatFeatureFlagBits::eBlitSrc | vk::FormatFeatureFlagBits::eBlitDst
+		| vk::FormatFeatureFlagBits::eSampledImageFilterLinear;
+	for (vk::Format format : { vk::Format::eR8G8B8A8Unorm, vk::Format::eR8G8B8A8Srgb }) {
+		vk::FormatProperties formatProperties = physicalDevice.getFormatProperties(format);
+		if ((formatProperties.optimalTilingFeatures & blitFeatures) == blitFeatures) {
+			support.blitFormats.push_back(format);
+		}
+	}
+
+	//block compressed formats need the device feature on top of format support
+	if (!physicalDevice.getFeatures().textureCompressionBC) {
+		return support;
+	}
+	std::vector<vk::Format> compressedFormats = {
+		vk::Format::eBc1RgbUnormBlock, vk::Format::eBc1RgbSrgbBlock,
+		vk::Format::eBc1RgbaUnormBlock, vk::Format::eBc1RgbaSrgbBlock,
+		vk::Format::eBc3UnormBlock, vk::Format::eBc3SrgbBlock,
+		vk::Format::eBc5UnormBlock,
+		vk::Format::eBc7UnormBlock, vk::Format::eBc7SrgbBlock
+	};
+	for (vk::Format format : compressedFormats) {
+		try {
+			support.compressedFormats.push_back(find_supported_format(
+				physicalDevice, { format }, vk::ImageTiling::eOptimal,
+				vk::FormatFeatureFlagBits::eSampledImage | vk::FormatFeatureFlagBits::eSampledImageFilterLinear
+			));
+		}
+		catch (std::runtime_error&) {
+			vkLogging::Logger::get_logger()->print_list({ "Can't sample ", vk::to_string(format), ", it will be decoded on the CPU" });
+		}
+	}
+
+	return support;
+}
+
+namespace {
+
+	//the format stored levels are uploaded in
+	vk::Format upload_format(vk::Format format, const vkImage::TextureSupport& support) {
+		if (!vkImage::is_block_compressed(format)
+			|| std::find(support.compressedFormats.begin(), support.compressedFormats.end(), format) != support.compressedFormats.end()) {
+			return format;
+		}
+		return vkImage::decoded_format(format);
+	}
+
+	//whether levels missing from a texture in this format can be blitted on the GPU
+	bool blits_mips(vk::Format format, const vkImage::TextureSupport& support) {
+		return std::find(support.blitFormats.begin(), support.blitFormats.end(), format) != support.blitFormats.end();
+	}
+
+	vk::DeviceSize upload_size(vk::Format format, int width, int height, uint32_t levels) {
+		vk::DeviceSize size = 0;
+		for (uint32_t level = 0; level < levels; ++level) {
+			size += vkImage::level_size(format, std::max(width >> level, 1), std::max(height >> level, 1));
+		}
+		return size;
+	}
+
+	/*
+	* Write levels 1 onwards of an RGBA8 chain after its first level, each
+	* filtered from a CPU copy of the last, since staging memory is slow to read back.
+	*/
+	void write_mip_chain(unsigned char* levelData, const unsigned char* firstLevel, int width, int height, uint32_t levels) {
+
+		const unsigned char* levelPixels = firstLevel;
+		std::vector<unsigned char> level, nextLevel;
+		for (uint32_t mipLevel = 1; mipLevel < levels; ++mipLevel) {
+
+			levelData += static_cast<size_t>(width) * height * 4;
+			nextLevel.resize(static_cast<size_t>(std::max(width / 2, 1)) * std::max(height / 2, 1) * 4);
+			vkImage::downsample_rgba8(levelPixels, width, height, nextLevel.data());
+
+			width = std::max(width / 2, 1);
+			height = std::max(height / 2, 1);
+			memcpy(levelData, nextLevel.data(), nextLevel.size());
+			level.swap(nextLevel);
+			levelPixels = level.data();
+		}
+	}
+
+	/*
+	* A KTX2 file may store only its first level and ask for the rest to be made
+	* at load time. RGBA8 levels are then blitted, or made on the CPU while decoding
+	* if blits aren't supported. Compressed levels can't be made either way, so
+	* those textures keep the levels they have.
+	*/
+	uint32_t ktx2_mip_levels(const vkImage::Ktx2Header& header, vk::Format format) {
+		return vkImage::is_block_compressed(format) ? static_cast<uint32_t>(header.levels.size()) : header.mipLevels;
+	}
+
+	//how many levels of a KTX2 texture are written to staging memory
+	uint32_t ktx2_written_levels(const vkImage::Ktx2Header& header, vk::Format format, const vkImage::TextureSupport& support) {
+		return blits_mips(format, support) ? static_cast<uint32_t>(header.levels.size()) : ktx2_mip_levels(header, format);
+	}
+
+	/*
+	* Read every stored level, largest first, into staging memory. Levels the
+	* device can sample are read straight in, others go through the CPU decoder.
+	*/
+	bool read_levels(vkImage::DecodedImage& decoded, vk::Format storedFormat, unsigned char* levelData,
+		const std::function<bool(uint32_t, size_t, void*)>& read_level) {
+
+		std::vector<unsigned char> blocks;
+		for (uint32_t level = 0; level < decoded.levels; ++level) {
+
+			int levelWidth = std::max(decoded.width >> level, 1);
+			int levelHeight = std::max(decoded.height >> level, 1);
+			size_t size = vkImage::level_size(storedFormat, levelWidth, levelHeight);
+			if (decoded.format == storedFormat) {
+				if (!read_level(level, size, levelData)) {
+					return false;
+				}
+			}
+			else {
+				blocks.resize(size);
+				if (!read_level(level, size, blocks.data())) {
+					return false;
+				}
+				vkImage::decode_blocks(storedFormat, blocks.data(), levelWidth, levelHeight, levelData);
+			}
+			levelData += vkImage::level_size(decoded.format, levelWidth, levelHeight);
+		}
+		return true;
+	}
+
+	vkImage::DecodedImage decode_ktx2(const char* filename, const vkUtil::StagingRegion& staging, const vkImage::TextureSupport& support) {
+
+		vkImage::DecodedImage decoded{};
+
+		std::ifstream file(filename, std::ios::binary);
+		vkImage::Ktx2Header header;
+		if (!vkImage::read_ktx2_header(file, header)) {
+			vkLogging::Logger::get_logger()->print_list({ "Failed to laod; ", filename });
+			return decoded;
+		}
+		decoded.width = header.width;
+		decoded.height = header.height;
+		decoded.channels = 4;
+		decoded.format = upload_format(header.format, support);
+		decoded.mipLevels = ktx2_mip_levels(header, decoded.format);
+		decoded.levels = static_cast<uint32_t>(header.levels.size());
+
+		bool read = read_levels(decoded, header.format, static_cast<unsigned char*>(staging.data),
+			[&](uint32_t level, size_t size, void* destination) {
+				file.seekg(static_cast<std::streamoff>(header.levels[level].offset));
+				return static_cast<bool>(file.read(static_cast<char*>(destination), static_cast<std::streamsize>(size)));
+			}
+		);
+		if (!read) {
+			vkLogging::Logger::get_logger()->print_list({ "Failed to laod; ", filename });
+			return decoded;
+		}
+		decoded.pixels = static_cast<stbi_uc*>(staging.data);
+
+		uint32_t writtenLevels = ktx2_written_levels(header, decoded.format, support);
+		if (writtenLevels > decoded.levels) {
+			std::vector<unsigned char> firstLevel(decoded.pixels, decoded.pixels + static_cast<size_t>(decoded.width) * decoded.height * 4);
+			write_mip_chain(decoded.pixels, firstLevel.data(), decoded.width, decoded.height, writtenLevels);
+			decoded.levels = writtenLevels;
+		}
+		return decoded;
+	}
+}
+
+vk::DeviceSize vkImage::packed_texture_size(const PackTexture& texture, const TextureSupport& support)
+{
+	vk::Format format = upload_format(static_cast<vk::Format>(texture.format), support);
+	return upload_size(format, static_cast<int>(texture.width), static_cast<int>(texture.height), texture.mipLevels);
+}
+
+vkImage::DecodedImage vkImage::read_packed_texture(const AssetPack& pack, const PackTexture& texture,
+	const vkUtil::StagingRegion& staging, const TextureSupport& support)
+{
+	vk::Format storedFormat = static_cast<vk::Format>(texture.format);
+
+	DecodedImage decoded{};
+	decoded.width = static_cast<int>(texture.width);
+	decoded.height = static_cast<int>(texture.height);
+	decoded.channels = 4;
+	decoded.format = upload_format(storedFormat, support);
+	decoded.mipLevels = texture.mipLevels;
+	decoded.levels = texture.mipLevels;
+
+	//the cooker packs levels back to back
+	uint64_t offset = texture.offset;
+	bool read = read_levels(decoded, storedFormat, static_cast<unsigned char*>(staging.data),
+		[&](uint32_t, size_t size, void* destination) {
+			bool levelRead = pack.read(offset, size, destination);
+			offset += size;
+			return levelRead;
+		}
 	);
+	if (!read) {
+		vkLogging::Logger::get_logger()->print_list({ "Failed to laod; ", texture.name });
+		return decoded;
+	}
+	decoded.pixels = static_cast<stbi_uc*>(staging.data);
+	return decoded;
 }
 
-void vkImage::Texture::load()
+vk::DeviceSize vkImage::decoded_size(const char* filename, const TextureSupport& support)
 {
-	pixels = stbi_load(filename, &width, &height, &channels, STBI_rgb_alpha);
+	if (is_ktx2(filename)) {
+		std::ifstream file(filename, std::ios::binary);
+		Ktx2Header header;
+		if (!read_ktx2_header(file, header)) {
+			return 0;
+		}
+		vk::Format format = upload_format(header.format, support);
+		return upload_size(format, header.width, header.height, ktx2_written_levels(header, format, support));
+	}
+
+	int width, height, channels;
+	if (!stbi_info(filename, &width, &height, &channels)) {
+		return 0;
+	}
+	if (!blits_mips(vk::Format::eR8G8B8A8Unorm, support)) {
+		return mip_chain_size(width, height);
+	}
+	//room for the extra byte stb_image asks for when decoding jpegs
+	return static_cast<vk::DeviceSize>(width) * height * 4 + 1;
+}
+
+vkImage::DecodedImage vkImage::decode_image(const char* filename, const vkUtil::StagingRegion& staging, const TextureSupport& support)
+{
+	if (is_ktx2(filename)) {
+		return decode_ktx2(filename, staging, support);
+	}
+
+	//without blits the whole mip chain is made here
+	bool mipChain = !blits_mips(vk::Format::eR8G8B8A8Unorm, support);
+
+	DecodedImage decoded{};
+	decoded.format = vk::Format::eR8G8B8A8Unorm;
+	decoded.levels = 1;
+
+	if (!stbi_info(filename, &decoded.width, &decoded.height, &decoded.channels)) {
+		vkLogging::Logger::get_logger()->print_list({ "Failed to laod; ", filename });
+		return decoded;
+	}
+	decoded.mipLevels = mip_level_count(decoded.width, decoded.height);
+	size_t size = static_cast<size_t>(decoded.width) * decoded.height * 4;
+	unsigned char* levelData = static_cast<unsigned char*>(staging.data);
+
+	//the CPU mip chain reads the pixels back, which staging memory is slow at
+	if (!mipChain) {
+		decodeTarget = { levelData, size, false };
+	}
+	stbi_uc* pixels = stbi_load(filename, &decoded.width, &decoded.height, &decoded.channels, STBI_rgb_alpha);
+	decodeTarget = {};
+
 	if (!pixels) {
 		vkLogging::Logger::get_logger()->print_list({ "Failed to laod; ", filename });
+		return decoded;
+	}
+	decoded.pixels = levelData;
+	if (pixels == levelData) {
+		return decoded;
+	}
+
+	//decoded somewhere else after all, or on purpose for the mip chain
+	memcpy(levelData, pixels, size);
+
+	if (mipChain) {
+		decoded.levels = decoded.mipLevels;
+		write_mip_chain(levelData, pixels, decoded.width, decoded.height, decoded.levels);
 	}
+
+	stbi_image_free(pixels);
+	return decoded;
 }
 
 void vkImage::Texture::populate()
 {
-	BufferInputChunk input;
-	input.logicalDevice = logicalDevice;
-	input.physicalDevice = physicalDevice;
-	input.memoryProperties = vk::MemoryPropertyFlagBits::eHostCoherent | vk::MemoryPropertyFlagBits::eHostVisible;
-	input.usage = vk::BufferUsageFlagBits::eTransferSrc;
-	input.size = width * height * 4;
-	Buffer stagingBuffer = vkUtil::createBuffer(input);
-
-	void* writeLocation = logicalDevice.mapMemory(stagingBuffer.bufferMemory, 0, input.size);
-	memcpy(writeLocation, pixels, input.size);
-	logicalDevice.unmapMemory(stagingBuffer.bufferMemory);
+	//levels the CPU didn't make while decoding are blitted from the first
+	bool blit = uploadedLevels < mipLevels;
+
+	//recorded now, submitted along with every other pending upload
+	vk::CommandBuffer commandBuffer = transfer->record();
 
 	ImageLayoutTransitionJob transitionJob;
 	transitionJob.commandBuffer = commandBuffer;
-	transitionJob.queue = queue;
 	transitionJob.image = image;
 	transitionJob.oldLayout = vk::ImageLayout::eUndefined;
 	transitionJob.newLayout = vk::ImageLayout::eTransferDstOptimal;
+	transitionJob.mipLevels = mipLevels;
 	transition_image_layout(transitionJob);
 
 	BufferImageCopyJob copyJob;
 	copyJob.commandBuffer = commandBuffer;
-	copyJob.queue = queue;
-	copyJob.srcBuffer = stagingBuffer.buffer;
+	copyJob.srcBuffer = staging.buffer;
+	copyJob.srcOffset = staging.offset;
 	copyJob.dstImage = image;
+	copyJob.mipLevel = 0;
 	copyJob.width = width;
 	copyJob.height = height;
 	copy_buffer_to_image(copyJob);
 
-	transitionJob.oldLayout = vk::ImageLayout::eTransferDstOptimal;
-	transitionJob.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
-	transition_image_layout(transitionJob);
+	for (uint32_t mipLevel = 1; mipLevel < uploadedLevels; ++mipLevel) {
+		copyJob.srcOffset += level_size(format, copyJob.width, copyJob.height);
+		copyJob.mipLevel = mipLevel;
+		copyJob.width = std::max(copyJob.width / 2, 1);
+		copyJob.height = std::max(copyJob.height / 2, 1);
+		copy_buffer_to_image(copyJob);
+	}
+
+	vk::ImageSubresourceRange range;
+	range.aspectMask = vk::ImageAspectFlagBits::eColor;
+	range.baseMipLevel = 0;
+	range.levelCount = mipLevels;
+	range.baseArrayLayer = 0;
+	range.layerCount = 1;
+
+	if (!blit) {
+		transfer->release_image(
+			image, range, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal,
+			vk::PipelineStageFlagBits::eFragmentShader, vk::AccessFlagBits::eShaderRead
+		);
+		return;
+	}
 
-	logicalDevice.freeMemory(stagingBuffer.bufferMemory);
-	logicalDevice.destroyBuffer(stagingBuffer.buffer);
+	MipChainJob mipJob;
+	mipJob.image = image;
+	mipJob.width = width;
+	mipJob.height = height;
+	mipJob.mipLevels = mipLevels;
+	transfer->finish_image(image, range, vk::ImageLayout::eTransferDstOptimal,
+		[mipJob](vk::CommandBuffer commandBuffer) mutable {
+			mipJob.commandBuffer = commandBuffer;
+			generate_mip_chain(mipJob);
+		}
+	);
 }
 
 void vkImage::Texture::make_view()
 {
-	imageView = make_image_view(logicalDevice, image, vk::Format::eR8G8B8A8Unorm, vk::ImageAspectFlagBits::eColor);
+	imageView = make_image_view(logicalDevice, image, format, vk::ImageAspectFlagBits::eColor, mipLevels);
 
 }
 
@@ -133,7 +494,7 @@ void vkImage::Texture::make_sampler()
 
 	vk::SamplerCreateInfo samplerInfo;
 	samplerInfo.flags = vk::SamplerCreateFlags();
-	samplerInfo.minFilter = vk::Filter::eNearest;
+	samplerInfo.minFilter = vk::Filter::eLinear;
 	samplerInfo.magFilter = vk::Filter::eLinear;
 	samplerInfo.addressModeU = vk::SamplerAddressMode::eRepeat;
 	samplerInfo.addressModeV = vk::SamplerAddressMode::eRepeat;
@@ -147,7 +508,7 @@ void vkImage::Texture::make_sampler()
 	samplerInfo.mipmapMode = vk::SamplerMipmapMode::eLinear;
 	samplerInfo.mipLodBias = 0.0f;
 	samplerInfo.minLod = 0.0f;
-	samplerInfo.maxLod = 0.0f;
+	samplerInfo.maxLod = static_cast<float>(mipLevels);
 
 	try {
 		sampler = logicalDevice.createSampler(samplerInfo);
@@ -157,10 +518,9 @@ void vkImage::Texture::make_sampler()
 	}
 }
 
-void vkImage::Texture::make_descriptor_set()
+void vkImage::Texture::write_descriptor(uint32_t slot)
 {
-	descriptorSet = vkInit::allocate_descriptor_set(logicalDevice, descriptorPool, layout);
-
+	//the array is update after bind, so this is fine while frames using it are in flight
 	vk::DescriptorImageInfo imageDescriptor;
 	imageDescriptor.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
 	imageDescriptor.imageView = imageView;
@@ -169,7 +529,7 @@ void vkImage::Texture::make_descriptor_set()
 	vk::WriteDescriptorSet descriptorWrite;
 	descriptorWrite.dstSet = descriptorSet;
 	descriptorWrite.dstBinding = 0;
-	descriptorWrite.dstArrayElement = 0;
+	descriptorWrite.dstArrayElement = slot;
 	descriptorWrite.descriptorType = vk::DescriptorType::eCombinedImageSampler;
 	descriptorWrite.descriptorCount = 1;
 	descriptorWrite.pImageInfo = &imageDescriptor;
@@ -204,7 +564,7 @@ vk::Image vkImage::make_image(ImageInputChunk input)
 	imageInfo.flags = vk::ImageCreateFlagBits();
 	imageInfo.imageType = vk::ImageType::e2D;
 	imageInfo.extent = vk::Extent3D(input.width, input.height, 1);
-	imageInfo.mipLevels = 1;
+	imageInfo.mipLevels = input.mipLevels;
 	imageInfo.arrayLayers = 1;
 	imageInfo.format = input.format;
 	imageInfo.tiling = input.tiling;
@@ -224,29 +584,25 @@ vk::Image vkImage::make_image(ImageInputChunk input)
 	
 }
 
-vk::DeviceMemory vkImage::make_image_memory(ImageInputChunk input, vk::Image image)
+MemoryAllocation vkImage::make_image_memory(ImageInputChunk input, vk::Image image)
 {
 	vk::MemoryRequirements requirements = input.logicalDevice.getImageMemoryRequirements(image);
 
-	vk::MemoryAllocateInfo allocation;
-	allocation.allocationSize = requirements.size;
-	allocation.memoryTypeIndex = vkUtil::findMemoryTypeIndex(
-		input.physicalDevice, requirements.memoryTypeBits, input.memoryProperties
-	);
 	try {
-		vk::DeviceMemory imageMemory = input.logicalDevice.allocateMemory(allocation);
-		input.logicalDevice.bindImageMemory(image, imageMemory, 0);
+		MemoryAllocation imageMemory = input.allocator->allocate(
+			requirements, input.memoryProperties, input.tiling == vk::ImageTiling::eLinear
+		);
+		input.logicalDevice.bindImageMemory(image, imageMemory.memory, imageMemory.offset);
 		return imageMemory;
 	}
 	catch (vk::SystemError err) {
 		vkLogging::Logger::get_logger()->print("Unable to allocate memory for image");
-		return nullptr;
+		return MemoryAllocation{};
 	}
 }
 
 void vkImage::transition_image_layout(ImageLayoutTransitionJob job)
 {
-	vkUtil::start_job(job.commandBuffer);
 	/*
 	* // Provided by VK_VERSION_1_0
 		typedef struct VkImageSubresourceRange {
@@ -261,7 +617,7 @@ void vkImage::transition_image_layout(ImageLayoutTransitionJob job)
 	vk::ImageSubresourceRange access;
 	access.aspectMask = vk::ImageAspectFlagBits::eColor;
 	access.baseMipLevel = 0;
-	access.levelCount = 1;
+	access.levelCount = job.mipLevels;
 	access.baseArrayLayer = 0;
 	access.layerCount = 1;
 
@@ -306,13 +662,10 @@ void vkImage::transition_image_layout(ImageLayoutTransitionJob job)
 	}
 
 	job.commandBuffer.pipelineBarrier(sourceStage, dstStage, vk::DependencyFlags(), nullptr, nullptr, barrier);
-
-	vkUtil::end_job(job.commandBuffer, job.queue);
 }
 
 void vkImage::copy_buffer_to_image(BufferImageCopyJob job)
 {
-	vkUtil::start_job(job.commandBuffer);
 	/*
 	* // Provided by VK_VERSION_1_0
 	typedef struct VkBufferImageCopy {
@@ -326,13 +679,13 @@ void vkImage::copy_buffer_to_image(BufferImageCopyJob job)
 	*/
 
 	vk::BufferImageCopy copy;
-	copy.bufferOffset = 0;
+	copy.bufferOffset = job.srcOffset;
 	copy.bufferRowLength = 0;
 	copy.bufferImageHeight = 0;
 
 	vk::ImageSubresourceLayers access;
 	access.aspectMask = vk::ImageAspectFlagBits::eColor;
-	access.mipLevel = 0;
+	access.mipLevel = job.mipLevel;
 	access.baseArrayLayer = 0;
 	access.layerCount = 1;
 
@@ -343,12 +696,77 @@ void vkImage::copy_buffer_to_image(BufferImageCopyJob job)
 	job.commandBuffer.copyBufferToImage(
 		job.srcBuffer, job.dstImage, vk::ImageLayout::eTransferDstOptimal, copy
 	);
+}
+
+void vkImage::generate_mip_chain(MipChainJob job)
+{
+	vk::ImageMemoryBarrier barrier;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = job.image;
+	barrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+
+	int width = job.width;
+	int height = job.height;
+	for (uint32_t level = 1; level < job.mipLevels; ++level) {
+
+		//the level above is complete, read from it
+		barrier.subresourceRange.baseMipLevel = level - 1;
+		barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+		barrier.newLayout = vk::ImageLayout::eTransferSrcOptimal;
+		barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+		barrier.dstAccessMask = vk::AccessFlagBits::eTransferRead;
+		job.commandBuffer.pipelineBarrier(
+			vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer,
+			vk::DependencyFlags(), nullptr, nullptr, barrier
+		);
+
+		int nextWidth = std::max(width / 2, 1);
+		int nextHeight = std::max(height / 2, 1);
+
+		vk::ImageBlit blit;
+		blit.srcSubresource = vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, level - 1, 0, 1);
+		blit.srcOffsets[0] = vk::Offset3D(0, 0, 0);
+		blit.srcOffsets[1] = vk::Offset3D(width, height, 1);
+		blit.dstSubresource = vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, level, 0, 1);
+		blit.dstOffsets[0] = vk::Offset3D(0, 0, 0);
+		blit.dstOffsets[1] = vk::Offset3D(nextWidth, nextHeight, 1);
+		job.commandBuffer.blitImage(
+			job.image, vk::ImageLayout::eTransferSrcOptimal,
+			job.image, vk::ImageLayout::eTransferDstOptimal,
+			blit, vk::Filter::eLinear
+		);
+
+		barrier.oldLayout = vk::ImageLayout::eTransferSrcOptimal;
+		barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+		barrier.srcAccessMask = vk::AccessFlagBits::eTransferRead;
+		barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+		job.commandBuffer.pipelineBarrier(
+			vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader,
+			vk::DependencyFlags(), nullptr, nullptr, barrier
+		);
 
+		width = nextWidth;
+		height = nextHeight;
+	}
 
-	vkUtil::end_job(job.commandBuffer, job.queue);
+	//the last level is only ever written
+	barrier.subresourceRange.baseMipLevel = job.mipLevels - 1;
+	barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+	barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+	barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+	barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+	job.commandBuffer.pipelineBarrier(
+		vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader,
+		vk::DependencyFlags(), nullptr, nullptr, barrier
+	);
 }
 
-vk::ImageView vkImage::make_image_view(vk::Device logicalDevice, vk::Image image, vk::Format format, vk::ImageAspectFlags aspect)
+vk::ImageView vkImage::make_image_view(vk::Device logicalDevice, vk::Image image, vk::Format format,
+	vk::ImageAspectFlags aspect, uint32_t mipLevels)
 {
 	/*
 			* ImageViewCreateInfo( VULKAN_HPP_NAMESPACE::ImageViewCreateFlags flags_ = {},
@@ -375,7 +793,7 @@ vk::ImageView vkImage::make_image_view(vk::Device logicalDevice, vk::Image image
 	createInfo.components.a = vk::ComponentSwizzle::eIdentity;
 	createInfo.subresourceRange.aspectMask = aspect;
 	createInfo.subresourceRange.baseMipLevel = 0;
-	createInfo.subresourceRange.levelCount = 1;
+	createInfo.subresourceRange.levelCount = mipLevels;
 	createInfo.subresourceRange.baseArrayLayer = 0;
 	createInfo.subresourceRange.layerCount = 1;
 
@@ -404,5 +822,5 @@ vk::Format vkImage::find_supported_format(vk::PhysicalDevice physicalDevice, con
 
 		
 	}
-	std::runtime_error("Unable to find suitable format");
+	throw std::runtime_error("Unable to find suitable format");
 }
@@ -1,25 +1,58 @@
 #pragma once
 
 #include "../../config.h"
+#include "../vkUtil/allocator.h"
+#include "../vkUtil/transfer.h"
+#include "../vkUtil/deletion_queue.h"
+#include "../../model/asset_pack.h"
 
 namespace vkImage {
+
+	/**
+		An image file decoded straight into staging memory, its
+		levels tightly packed from the start of the region.
+	*/
+	struct DecodedImage {
+		stbi_uc* pixels;
+		int width, height, channels;
+		//RGBA8 or, for KTX2 files the device can sample, block compressed
+		vk::Format format;
+		//how many mip levels the texture has, and how many were written (the rest are blitted on the GPU)
+		uint32_t mipLevels, levels;
+	};
+
+	/**
+		What the device can do with textures, which decides how files are decoded.
+	*/
+	struct TextureSupport {
+		//the RGBA8 formats whose mip chains can be blitted, in the rest every level is made on the CPU
+		std::vector<vk::Format> blitFormats;
+		//the block compressed formats which can be sampled, the rest are decoded to RGBA8
+		std::vector<vk::Format> compressedFormats;
+	};
+
 	struct  TextureInputChunk {
 		vk::Device logicalDevice;
 		vk::PhysicalDevice physicalDevice;
-		const char* filename;
-		
+		vkUtil::MemoryAllocator* allocator;
+		//the decoded pixels, and the staging region they were decoded into
+		DecodedImage decoded;
+		vkUtil::StagingRegion staging;
 
-		vk::CommandBuffer commandBuffer;
-		vk::Queue queue;
-		vk::DescriptorSetLayout layout;
-		vk::DescriptorPool descriptorPool;
+		vkUtil::TransferContext* transfer;
+
+		//the bindless material array, and the slot to register the texture into
+		vk::DescriptorSet descriptorSet;
+		uint32_t slot;
 
 	};
 
 	struct ImageInputChunk {
 		vk::Device logicalDevice;
 		vk::PhysicalDevice physicalDevice;
+		vkUtil::MemoryAllocator* allocator;
 		int width, height;
+		uint32_t mipLevels;
 		vk::ImageTiling tiling;
 		vk::ImageUsageFlags usage;
 		vk::MemoryPropertyFlags memoryProperties;
@@ -28,48 +61,72 @@ namespace vkImage {
 
 	struct ImageLayoutTransitionJob {
 		vk::CommandBuffer commandBuffer;
-		vk::Queue queue;
 		vk::Image image;
 		vk::ImageLayout oldLayout, newLayout;
+		uint32_t mipLevels;
 	};
 
 
 	struct BufferImageCopyJob {
 		vk::CommandBuffer commandBuffer;
-		vk::Queue queue;
 		vk::Buffer srcBuffer;
+		vk::DeviceSize srcOffset;
 		vk::Image dstImage;
+		uint32_t mipLevel;
 		int width, height;
 	};
+
+	struct MipChainJob {
+		vk::CommandBuffer commandBuffer;
+		vk::Image image;
+		int width, height;
+		uint32_t mipLevels;
+	};
 	class Texture {
 	public:
 		Texture(TextureInputChunk info);
 		~Texture();
 
-		void use(vk::CommandBuffer commandBuffer, vk::PipelineLayout pipelineLayout);
+		/**
+			Hand the texture's resources to a deletion queue instead of destroying
+			them straight away, for textures dropped while frames drawing with them
+			may still be in flight. Deleting the texture afterwards frees nothing.
+			Its material slot must not be drawn with until another texture is written to it.
+
+			\param deletionQueue the queue which will destroy the resources
+			\param lastUse the timeline value of the last submission sampling the texture
+		*/
+		void retire(vkUtil::DeletionQueue& deletionQueue, uint64_t lastUse);
+
+		/**
+			Point a slot of the material array at the texture. Its own slot is
+			written when it's made, other slots can share it, like fallbacks do.
+
+			\param slot the index into the material array
+		*/
+		void write_descriptor(uint32_t slot);
 
 	private:
 		int width, height, channels;
+		vk::Format format;
+		uint32_t mipLevels;
 		vk::Device logicalDevice;
 		vk::PhysicalDevice physicalDevice;
-		const char* filename;
-		stbi_uc* pixels;
+		vkUtil::MemoryAllocator* allocator;
+		vkUtil::StagingRegion staging;
+		uint32_t uploadedLevels;
 
 		// Resources
 		vk::Image image;
-		vk::DeviceMemory imageMemory;
+		MemoryAllocation imageMemory;
 		vk::ImageView imageView;
 		vk::Sampler sampler;
 
 		// Resource Descriptors
-		vk::DescriptorSetLayout layout;
 		vk::DescriptorSet descriptorSet;
-		vk::DescriptorPool descriptorPool;
-
-		vk::CommandBuffer commandBuffer;
-		vk::Queue queue;
+		uint32_t slot;
 
-		void load();
+		vkUtil::TransferContext* transfer;
 
 		void populate();
 
@@ -77,19 +134,89 @@ namespace vkImage {
 
 		void make_sampler();
 
-		void make_descriptor_set();
-
 	};
 
+	/**
+		\param physicalDevice the physical device
+		\returns how textures can be uploaded and sampled on the device
+	*/
+	TextureSupport query_texture_support(vk::PhysicalDevice physicalDevice);
+
+	/**
+		Read an image file's header to find how much staging memory
+		decode_image will need for it.
+
+		\param filename the path to the image file
+		\param support what the device can do with textures
+		\returns the size (in bytes) of staging memory to reserve, 0 if the file can't be read
+	*/
+	vk::DeviceSize decoded_size(const char* filename, const TextureSupport& support);
+
+	/**
+		Decode an image file straight into staging memory. KTX2 files are
+		read as they are, with all their levels, unless the device can't
+		sample their format, then they're decoded to RGBA8. Anything else
+		is decoded to RGBA8 by stb_image.
+		Touches no Vulkan state, so many files can be decoded on different threads at once.
+
+		\param filename the path to the image file
+		\param staging where to write the pixels, at least decoded_size bytes
+		\param support what the device can do with textures
+		\returns the decoded image, its pixels are null if decoding failed
+	*/
+	DecodedImage decode_image(const char* filename, const vkUtil::StagingRegion& staging, const TextureSupport& support);
+
+	/**
+		\param texture a texture in an asset pack, AssetPack::open has checked its levels
+		\param support what the device can do with textures
+		\returns the size (in bytes) of staging memory read_packed_texture will need for it
+	*/
+	vk::DeviceSize packed_texture_size(const PackTexture& texture, const TextureSupport& support);
+
+	/**
+		Read a texture from an asset pack straight into staging memory, its
+		levels are stored ready to upload. If the device can't sample their
+		format, they're decoded to RGBA8 instead.
+		Touches no Vulkan state, so many textures can be read on different threads at once.
+
+		\param pack the pack holding the texture
+		\param texture the texture's entry in the pack
+		\param staging where to write the levels, at least packed_texture_size bytes
+		\param support what the device can do with textures
+		\returns the read image, its pixels are null if reading failed
+	*/
+	DecodedImage read_packed_texture(const AssetPack& pack, const PackTexture& texture,
+		const vkUtil::StagingRegion& staging, const TextureSupport& support);
+
 	vk::Image make_image(ImageInputChunk input);
 
-	vk::DeviceMemory make_image_memory(ImageInputChunk input, vk::Image image);
+	MemoryAllocation make_image_memory(ImageInputChunk input, vk::Image image);
+
+	/**
+		Record an image layout transition.
 
+		\param job the command buffer to record into, the image and its layouts
+	*/
 	void transition_image_layout(ImageLayoutTransitionJob job);
 
+	/**
+		Record a copy from a buffer into an image.
+
+		\param job the command buffer to record into, the source and destination
+	*/
 	void copy_buffer_to_image(BufferImageCopyJob job);
 
-	vk::ImageView make_image_view(vk::Device logicalDevice, vk::Image image, vk::Format format, vk::ImageAspectFlags aspect);
+	/**
+		Record blits filling every mip level from the one above it.
+		Every level must be in eTransferDstOptimal with level 0 written,
+		they're all left in eShaderReadOnlyOptimal for the fragment shader.
+
+		\param job the command buffer to record into, the image and its size
+	*/
+	void generate_mip_chain(MipChainJob job);
+
+	vk::ImageView make_image_view(vk::Device logicalDevice, vk::Image image, vk::Format format,
+		vk::ImageAspectFlags aspect, uint32_t mipLevels);
 
 	vk::Format find_supported_format(
 		vk::PhysicalDevice physicalDevice, 
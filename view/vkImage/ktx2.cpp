@@ -0,0 +1,82 @@
+#include "ktx2.h"
+#include "blocks.h"
+#include "mipmaps.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+	const unsigned char ktx2Identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+	//the fixed size start of a KTX2 file, every field is little endian
+	struct Ktx2FileHeader {
+		unsigned char identifier[12];
+		uint32_t vkFormat, typeSize;
+		uint32_t pixelWidth, pixelHeight, pixelDepth;
+		uint32_t layerCount, faceCount, levelCount;
+		uint32_t supercompressionScheme;
+		uint32_t dfdByteOffset, dfdByteLength;
+		uint32_t kvdByteOffset, kvdByteLength;
+		uint64_t sgdByteOffset, sgdByteLength;
+	};
+	static_assert(sizeof(Ktx2FileHeader) == 80, "KTX2 header must match the file layout");
+
+	//one entry of the level index, which follows the header
+	struct Ktx2FileLevel {
+		uint64_t byteOffset, byteLength, uncompressedByteLength;
+	};
+}
+
+bool vkImage::is_ktx2(const char* filename)
+{
+	size_t length = strlen(filename);
+	return length >= 5 && strcmp(filename + length - 5, ".ktx2") == 0;
+}
+
+bool vkImage::read_ktx2_header(std::istream& file, Ktx2Header& header)
+{
+	Ktx2FileHeader fileHeader;
+	if (!file.read(reinterpret_cast<char*>(&fileHeader), sizeof(fileHeader))
+		|| memcmp(fileHeader.identifier, ktx2Identifier, sizeof(ktx2Identifier)) != 0) {
+		return false;
+	}
+
+	header.format = static_cast<vk::Format>(fileHeader.vkFormat);
+	bool knownFormat = is_block_compressed(header.format)
+		|| header.format == vk::Format::eR8G8B8A8Unorm || header.format == vk::Format::eR8G8B8A8Srgb;
+
+	//arrays, cubemaps, 3D textures and supercompressed data aren't handled
+	if (!knownFormat || fileHeader.pixelWidth == 0 || fileHeader.pixelHeight == 0 || fileHeader.pixelDepth != 0
+		|| fileHeader.layerCount > 1 || fileHeader.faceCount != 1 || fileHeader.supercompressionScheme != 0) {
+		return false;
+	}
+	header.width = static_cast<int>(fileHeader.pixelWidth);
+	header.height = static_cast<int>(fileHeader.pixelHeight);
+
+	//a level count of 0 asks for the chain to be made at load time, only the first level is stored
+	header.mipLevels = mip_level_count(header.width, header.height);
+	if (fileHeader.levelCount > header.mipLevels) {
+		return false;
+	}
+	uint32_t levelCount = std::max(fileHeader.levelCount, 1u);
+	if (fileHeader.levelCount != 0) {
+		header.mipLevels = levelCount;
+	}
+	header.levels.resize(levelCount);
+	for (uint32_t level = 0; level < levelCount; ++level) {
+
+		Ktx2FileLevel fileLevel;
+		if (!file.read(reinterpret_cast<char*>(&fileLevel), sizeof(fileLevel))) {
+			return false;
+		}
+
+		int width = std::max(header.width >> level, 1);
+		int height = std::max(header.height >> level, 1);
+		if (fileLevel.byteLength != level_size(header.format, width, height)) {
+			return false;
+		}
+		header.levels[level] = { fileLevel.byteOffset, fileLevel.byteLength };
+	}
+
+	return true;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "../../config.h"
+
+namespace vkImage {
+
+	/**
+		Where one mip level's data sits in a KTX2 file.
+	*/
+	struct Ktx2Level {
+		uint64_t offset, size;
+	};
+
+	/**
+		The parts of a KTX2 file's header needed to upload its texture.
+	*/
+	struct Ktx2Header {
+		vk::Format format;
+		int width, height;
+		//level 0 is the full size image
+		std::vector<Ktx2Level> levels;
+		//how many levels the texture should have, more than are stored if the rest are to be made at load time
+		uint32_t mipLevels;
+	};
+
+	/**
+		\param filename the path to an image file
+		\returns whether the file should be loaded as KTX2, going by its extension
+	*/
+	bool is_ktx2(const char* filename);
+
+	/**
+		Read a KTX2 file's header and level index. Only 2D textures in RGBA8
+		or a block compressed format, without supercompression, are supported.
+		Files with more levels than the image's size allows are rejected.
+
+		\param file the opened file, read from its start
+		\param header populated with the header on success
+		\returns whether the file is a KTX2 file which can be loaded
+	*/
+	bool read_ktx2_header(std::istream& file, Ktx2Header& header);
+}
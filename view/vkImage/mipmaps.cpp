@@ -0,0 +1,105 @@
+#include "mipmaps.h"
+#include "../vkUtil/cpu_features.h"
+#include <algorithm>
+
+/*
+* Each output texel is the rounded average of a 2x2 block. An odd last
+* row or column is dropped, except at a size of 1 where it's reused,
+* which is what halving the extent with a blit would cover too.
+*/
+
+uint32_t vkImage::mip_level_count(int width, int height)
+{
+	uint32_t levels = 1;
+	for (int size = std::max(width, height); size > 1; size /= 2) {
+		++levels;
+	}
+	return levels;
+}
+
+size_t vkImage::mip_chain_size(int width, int height)
+{
+	size_t size = 0;
+	uint32_t levels = mip_level_count(width, height);
+	for (uint32_t level = 0; level < levels; ++level) {
+		size += static_cast<size_t>(width) * height * 4;
+		width = std::max(width / 2, 1);
+		height = std::max(height / 2, 1);
+	}
+	return size;
+}
+
+void vkImage::downsample_rgba8(const unsigned char* src, int srcWidth, int srcHeight, unsigned char* dst)
+{
+	int dstWidth = std::max(srcWidth / 2, 1);
+	int dstHeight = std::max(srcHeight / 2, 1);
+
+	for (int y = 0; y < dstHeight; ++y) {
+
+		const unsigned char* row0 = src + static_cast<size_t>(2 * y) * srcWidth * 4;
+		const unsigned char* row1 = src + static_cast<size_t>(std::min(2 * y + 1, srcHeight - 1)) * srcWidth * 4;
+		unsigned char* out = dst + static_cast<size_t>(y) * dstWidth * 4;
+
+		int x = 0;
+
+		//eight source texels (32 bytes) of each row make four output texels
+#if defined(VKUTIL_X86)
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i rounding = _mm_set1_epi16(2);
+		for (; 2 * (x + 4) <= srcWidth; x += 4) {
+
+			__m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 8 * x));
+			__m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 8 * x + 16));
+			__m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 8 * x));
+			__m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 8 * x + 16));
+
+			//widened to 16 bits, each register holds the column sums of two neighbouring texels
+			__m128i s0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+			__m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+			__m128i s2 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+			__m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+
+			//add the two texels of each register, the block sum lands in the low half
+			s0 = _mm_add_epi16(s0, _mm_srli_si128(s0, 8));
+			s1 = _mm_add_epi16(s1, _mm_srli_si128(s1, 8));
+			s2 = _mm_add_epi16(s2, _mm_srli_si128(s2, 8));
+			s3 = _mm_add_epi16(s3, _mm_srli_si128(s3, 8));
+
+			__m128i sum01 = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(s0, s1), rounding), 2);
+			__m128i sum23 = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(s2, s3), rounding), 2);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4 * x), _mm_packus_epi16(sum01, sum23));
+		}
+#elif defined(VKUTIL_NEON)
+		for (; 2 * (x + 4) <= srcWidth; x += 4) {
+
+			uint8x16_t a0 = vld1q_u8(row0 + 8 * x);
+			uint8x16_t a1 = vld1q_u8(row0 + 8 * x + 16);
+			uint8x16_t b0 = vld1q_u8(row1 + 8 * x);
+			uint8x16_t b1 = vld1q_u8(row1 + 8 * x + 16);
+
+			uint16x8_t s0 = vaddl_u8(vget_low_u8(a0), vget_low_u8(b0));
+			uint16x8_t s1 = vaddl_u8(vget_high_u8(a0), vget_high_u8(b0));
+			uint16x8_t s2 = vaddl_u8(vget_low_u8(a1), vget_low_u8(b1));
+			uint16x8_t s3 = vaddl_u8(vget_high_u8(a1), vget_high_u8(b1));
+
+			uint16x8_t sum01 = vcombine_u16(
+				vadd_u16(vget_low_u16(s0), vget_high_u16(s0)), vadd_u16(vget_low_u16(s1), vget_high_u16(s1)));
+			uint16x8_t sum23 = vcombine_u16(
+				vadd_u16(vget_low_u16(s2), vget_high_u16(s2)), vadd_u16(vget_low_u16(s3), vget_high_u16(s3)));
+
+			//rounding shift right, (sum + 2) >> 2
+			vst1q_u8(out + 4 * x, vcombine_u8(vrshrn_n_u16(sum01, 2), vrshrn_n_u16(sum23, 2)));
+		}
+#endif
+
+		for (; x < dstWidth; ++x) {
+			int left = 2 * x;
+			int right = std::min(2 * x + 1, srcWidth - 1);
+			for (int channel = 0; channel < 4; ++channel) {
+				int sum = row0[4 * left + channel] + row0[4 * right + channel]
+					+ row1[4 * left + channel] + row1[4 * right + channel];
+				out[4 * x + channel] = static_cast<unsigned char>((sum + 2) >> 2);
+			}
+		}
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "../../config.h"
+
+namespace vkImage {
+
+	/**
+		\param width the width of the full size image
+		\param height the height of the full size image
+		\returns how many levels a full mip chain for the image has
+	*/
+	uint32_t mip_level_count(int width, int height);
+
+	/**
+		\returns the size (in bytes) of a full RGBA8 mip chain, every level tightly packed
+	*/
+	size_t mip_chain_size(int width, int height);
+
+	/**
+		Make the next mip level of an RGBA8 image on the CPU, averaging each
+		2x2 block of texels. Uses SSE2 or NEON to filter four texels at once.
+		Used when the GPU can't blit the image's format with linear filtering.
+
+		\param src the level to filter, tightly packed
+		\param srcWidth the width of the level
+		\param srcHeight the height of the level
+		\param dst the next level is written here, it's half the size (rounded down, at least 1)
+	*/
+	void downsample_rgba8(const unsigned char* src, int srcWidth, int srcHeight, unsigned char* dst);
+}
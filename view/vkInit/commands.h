@@ -11,24 +11,21 @@ namespace vkInit {
 	struct commandBufferInputChunk {
 		vk::Device device; 
 		vk::CommandPool commandPool;
-		std::vector<vkUtil::SwapChainFrame>& frames;
+		std::vector<vkUtil::FrameContext>& frames;
 	};
 
 	/**
-		Make a command pool.
+		Make a command pool for the given queue family.
 
 		\param device the logical device
-		\param physicalDevice the physical device
-		\param surface the windows surface (used for getting the queue families)
+		\param queueFamilyIndex the family whose queues will run the pool's command buffers
 		\returns the created command pool
 	*/
-	vk::CommandPool make_command_pool(vk::Device device, vk::PhysicalDevice physicalDevice, vk::SurfaceKHR surface) {
-
-		vkUtil::QueueFamilyIndices queueFamilyIndices = vkUtil::findQueueFamilies(physicalDevice, surface);
+	vk::CommandPool make_command_pool(vk::Device device, uint32_t queueFamilyIndex) {
 
 		vk::CommandPoolCreateInfo poolInfo;
 		poolInfo.flags = vk::CommandPoolCreateFlags() | vk::CommandPoolCreateFlagBits::eResetCommandBuffer;
-		poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
+		poolInfo.queueFamilyIndex = queueFamilyIndex;
 
 		try {
 			return device.createCommandPool(poolInfo);
@@ -40,6 +37,21 @@ namespace vkInit {
 			return nullptr;
 		}
 	}
+
+	/**
+		Make a command pool for the graphics queue family.
+
+		\param device the logical device
+		\param physicalDevice the physical device
+		\param surface the windows surface (used for getting the queue families)
+		\returns the created command pool
+	*/
+	vk::CommandPool make_command_pool(vk::Device device, vk::PhysicalDevice physicalDevice, vk::SurfaceKHR surface) {
+
+		vkUtil::QueueFamilyIndices queueFamilyIndices = vkUtil::findQueueFamilies(physicalDevice, surface);
+
+		return make_command_pool(device, queueFamilyIndices.graphicsFamily.value());
+	}
 	
 	/**
 		Make a main command buffer.
@@ -18,10 +18,17 @@ namespace vkInit {
 		}
 
 		vk::DescriptorSetLayoutCreateInfo layoutInfo;
-		layoutInfo.flags = vk::DescriptorSetLayoutCreateFlagBits();
+		layoutInfo.flags = bindings.layoutFlags;
 		layoutInfo.bindingCount = bindings.count;
 		layoutInfo.pBindings = layoutBindings.data();
 
+		vk::DescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo;
+		if (!bindings.bindingFlags.empty()) {
+			bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindings.bindingFlags.size());
+			bindingFlagsInfo.pBindingFlags = bindings.bindingFlags.data();
+			layoutInfo.pNext = &bindingFlagsInfo;
+		}
+
 		try {
 			return device.createDescriptorSetLayout(layoutInfo);
 		}
@@ -31,18 +38,19 @@ namespace vkInit {
 		}
 	}
 
-	vk::DescriptorPool make_descriptor_pool(vk::Device device, uint32_t size, const DescriptorSetLayoutData& bindings) {
+	vk::DescriptorPool make_descriptor_pool(vk::Device device, uint32_t size, const DescriptorSetLayoutData& bindings,
+		vk::DescriptorPoolCreateFlags flags) {
 		std::vector<vk::DescriptorPoolSize> poolSizes;
 
 		for (int i = 0; i < bindings.count; i++) {
 			vk::DescriptorPoolSize poolSize;
 			poolSize.type = bindings.types[i];
-			poolSize.descriptorCount = size;
+			poolSize.descriptorCount = bindings.counts.empty() ? size : size * bindings.counts[i];
 			poolSizes.push_back(poolSize);
 		}
 
 		vk::DescriptorPoolCreateInfo poolInfo;
-		poolInfo.flags = vk::DescriptorPoolCreateFlags();
+		poolInfo.flags = flags;
 		poolInfo.maxSets = size;
 		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
 		poolInfo.pPoolSizes = poolSizes.data();
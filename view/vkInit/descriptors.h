@@ -9,11 +9,24 @@ namespace vkInit {
 		std::vector<vk::DescriptorType> types;
 		std::vector<int> counts;
 		std::vector<vk::ShaderStageFlags> stages;
+		//optional, one entry per binding (descriptor indexing)
+		std::vector<vk::DescriptorBindingFlagsEXT> bindingFlags;
+		vk::DescriptorSetLayoutCreateFlags layoutFlags;
 	};
 
 	vk::DescriptorSetLayout make_descriptor_set_layout(vk::Device device, const DescriptorSetLayoutData& bindings);
 
-	vk::DescriptorPool make_descriptor_pool(vk::Device device, uint32_t size, const DescriptorSetLayoutData& bindings);
+	/**
+		Make a descriptor pool.
+
+		\param device the logical device
+		\param size how many sets the pool can hold
+		\param bindings the types of descriptor in each set, and their counts if any are arrays
+		\param flags creation flags for the pool
+		\returns the created pool
+	*/
+	vk::DescriptorPool make_descriptor_pool(vk::Device device, uint32_t size, const DescriptorSetLayoutData& bindings,
+		vk::DescriptorPoolCreateFlags flags = vk::DescriptorPoolCreateFlags());
 
 	vk::DescriptorSet allocate_descriptor_set(
 	vk::Device device, vk::DescriptorPool descriptorPool,
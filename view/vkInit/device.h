@@ -62,10 +62,11 @@ namespace vkInit {
 
 		/*
 		* A device is suitable if it can present to the screen, ie support
-		* the swapchain extension
+		* the swapchain extension, and index materials from a descriptor array
 		*/
 		const std::vector<const char*> requestedExtensions = {
-			VK_KHR_SWAPCHAIN_EXTENSION_NAME
+			VK_KHR_SWAPCHAIN_EXTENSION_NAME,
+			VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME
 		};
 
 		vkLogging::Logger::get_logger()->print("We are requesting device extensions:");
@@ -84,9 +85,62 @@ namespace vkInit {
 			vkLogging::Logger::get_logger()->print("Device can't support the requested extensions!");
 			return false;
 		}
+
+		/*
+		* The fragment shader picks its texture from one big array using
+		* the material of the draw it belongs to, found through gl_DrawID
+		*/
+		auto features = device.getFeatures2<vk::PhysicalDeviceFeatures2,
+			vk::PhysicalDeviceDescriptorIndexingFeaturesEXT, vk::PhysicalDeviceShaderDrawParametersFeatures,
+			vk::PhysicalDeviceTimelineSemaphoreFeatures>();
+		const vk::PhysicalDeviceDescriptorIndexingFeaturesEXT& indexing = features.get<vk::PhysicalDeviceDescriptorIndexingFeaturesEXT>();
+		if (!indexing.runtimeDescriptorArray || !indexing.descriptorBindingPartiallyBound
+			|| !indexing.descriptorBindingSampledImageUpdateAfterBind || !indexing.shaderSampledImageArrayNonUniformIndexing
+			|| !features.get<vk::PhysicalDeviceShaderDrawParametersFeatures>().shaderDrawParameters) {
+			vkLogging::Logger::get_logger()->print("Device can't support bindless materials!");
+			return false;
+		}
+
+		/*
+		* Every indirect draw starts at its group's slot in the visible
+		* instance list, which it passes as firstInstance
+		*/
+		if (!features.get<vk::PhysicalDeviceFeatures2>().features.drawIndirectFirstInstance) {
+			vkLogging::Logger::get_logger()->print("Device can't support indirect draws with a first instance!");
+			return false;
+		}
+
+		/*
+		* Every submission signals a timeline semaphore, which is how the
+		* engine knows what the GPU has finished with
+		*/
+		if (device.getProperties().apiVersion < VK_API_VERSION_1_2
+			|| !features.get<vk::PhysicalDeviceTimelineSemaphoreFeatures>().timelineSemaphore) {
+			vkLogging::Logger::get_logger()->print("Device can't support timeline semaphores!");
+			return false;
+		}
 		return true;
 	}
 
+	/**
+		Check whether presents can signal a fence once they're done with their images,
+		through VK_EXT_swapchain_maintenance1.
+
+		\param device the physical device
+		\param surfaceMaintenance whether the instance enabled the surface extensions it depends on
+		\returns whether present fences can be used
+	*/
+	bool supports_present_fences(const vk::PhysicalDevice& device, bool surfaceMaintenance) {
+
+		if (!surfaceMaintenance
+			|| !checkDeviceExtensionSupport(device, { VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME })) {
+			return false;
+		}
+
+		auto features = device.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceSwapchainMaintenance1FeaturesEXT>();
+		return features.get<vk::PhysicalDeviceSwapchainMaintenance1FeaturesEXT>().swapchainMaintenance1;
+	}
+
 	/**
 		Choose a physical device for the vulkan instance.
 
@@ -136,9 +190,10 @@ namespace vkInit {
 
 		\param physicalDevice the Physical Device to represent
 		\param surface the window surface
+		\param presentFences whether to enable VK_EXT_swapchain_maintenance1, see supports_present_fences
 		\returns the created device
 	*/
-	vk::Device create_logical_device(vk::PhysicalDevice physicalDevice, vk::SurfaceKHR surface) {
+	vk::Device create_logical_device(vk::PhysicalDevice physicalDevice, vk::SurfaceKHR surface, bool presentFences) {
 
 		/*
 		* Create an abstraction around the GPU
@@ -155,6 +210,10 @@ namespace vkInit {
 		if (indices.graphicsFamily.value() != indices.presentFamily.value()) {
 			uniqueIndices.push_back(indices.presentFamily.value());
 		}
+		if (indices.transferFamily.value() != indices.graphicsFamily.value()
+			&& indices.transferFamily.value() != indices.presentFamily.value()) {
+			uniqueIndices.push_back(indices.transferFamily.value());
+		}
 		/*
 		* VULKAN_HPP_CONSTEXPR DeviceQueueCreateInfo( VULKAN_HPP_NAMESPACE::DeviceQueueCreateFlags flags_            = {},
                                                 uint32_t                                     queueFamilyIndex_ = {},
@@ -177,14 +236,46 @@ namespace vkInit {
 		*/
 
 		vk::PhysicalDeviceFeatures deviceFeatures = vk::PhysicalDeviceFeatures();
+		vk::PhysicalDeviceFeatures supportedFeatures = physicalDevice.getFeatures();
+
+		//lets one indirect call issue many draws, used when available
+		deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+		//isSuitable checked it's supported, every indirect draw needs it
+		deviceFeatures.drawIndirectFirstInstance = true;
+		//block compressed textures are decoded on the CPU without it
+		deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
 
 		/*
 		* Device extensions to be requested:
 		*/
 		std::vector<const char*> deviceExtensions = {
-			VK_KHR_SWAPCHAIN_EXTENSION_NAME
+			VK_KHR_SWAPCHAIN_EXTENSION_NAME,
+			VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME
 		};
 
+		//isSuitable checked these are supported
+		vk::PhysicalDeviceTimelineSemaphoreFeatures timelineFeatures;
+		timelineFeatures.timelineSemaphore = true;
+
+		vk::PhysicalDeviceShaderDrawParametersFeatures drawParameterFeatures;
+		drawParameterFeatures.shaderDrawParameters = true;
+		drawParameterFeatures.pNext = &timelineFeatures;
+
+		vk::PhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures;
+		indexingFeatures.runtimeDescriptorArray = true;
+		indexingFeatures.descriptorBindingPartiallyBound = true;
+		indexingFeatures.descriptorBindingSampledImageUpdateAfterBind = true;
+		indexingFeatures.shaderSampledImageArrayNonUniformIndexing = true;
+		indexingFeatures.pNext = &drawParameterFeatures;
+
+		//lets presents signal a fence, so retired swapchains can go as soon as they're done
+		vk::PhysicalDeviceSwapchainMaintenance1FeaturesEXT swapchainMaintenanceFeatures;
+		swapchainMaintenanceFeatures.swapchainMaintenance1 = true;
+		if (presentFences) {
+			deviceExtensions.push_back(VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME);
+			timelineFeatures.pNext = &swapchainMaintenanceFeatures;
+		}
+
 		/*
 		* VULKAN_HPP_CONSTEXPR DeviceCreateInfo( VULKAN_HPP_NAMESPACE::DeviceCreateFlags flags_                         = {},
                                            uint32_t                                queueCreateInfoCount_          = {},
@@ -206,6 +297,7 @@ namespace vkInit {
 			static_cast<uint32_t>(deviceExtensions.size()), deviceExtensions.data(),
 			&deviceFeatures
 		);
+		deviceInfo.pNext = &indexingFeatures;
 
 		try {
 			vk::Device device = physicalDevice.createDevice(deviceInfo);
@@ -225,15 +317,16 @@ namespace vkInit {
 		\param physicalDevice the physical device
 		\param device the logical device
 		\param surface the window surface
-		\returns the queues
+		\returns the graphics, present and transfer queues
 	*/
-	std::array<vk::Queue,2> get_queues(vk::PhysicalDevice physicalDevice, vk::Device device, vk::SurfaceKHR surface) {
+	std::array<vk::Queue,3> get_queues(vk::PhysicalDevice physicalDevice, vk::Device device, vk::SurfaceKHR surface) {
 
 		vkUtil::QueueFamilyIndices indices = vkUtil::findQueueFamilies(physicalDevice, surface);
 
 		return { {
 				device.getQueue(indices.graphicsFamily.value(), 0),
 				device.getQueue(indices.presentFamily.value(), 0),
+				device.getQueue(indices.transferFamily.value(), 0),
 			} };
 	}
 
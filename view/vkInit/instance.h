@@ -75,6 +75,25 @@ namespace vkInit {
 		return true;
 	}
 
+	/**
+		Check whether the instance extensions swapchain present fences depend on
+		are available. They're optional, the instance is made without them otherwise.
+
+		\returns whether VK_EXT_surface_maintenance1 and VK_KHR_get_surface_capabilities2 are supported.
+	*/
+	bool supports_surface_maintenance() {
+
+		bool surfaceMaintenance = false;
+		bool surfaceCapabilities = false;
+		for (vk::ExtensionProperties extension : vk::enumerateInstanceExtensionProperties()) {
+			surfaceMaintenance = surfaceMaintenance
+				|| strcmp(extension.extensionName, VK_EXT_SURFACE_MAINTENANCE_1_EXTENSION_NAME) == 0;
+			surfaceCapabilities = surfaceCapabilities
+				|| strcmp(extension.extensionName, VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME) == 0;
+		}
+		return surfaceMaintenance && surfaceCapabilities;
+	}
+
 	/**
 		Create a Vulkan instance.
 
@@ -126,8 +145,9 @@ namespace vkInit {
 		/*
 		* Or drop down to an earlier version to ensure compatibility with more devices
 		* VK_MAKE_API_VERSION(variant, major, minor, patch)
+		* 1.2 is the earliest with timeline semaphores in core
 		*/
-		version = VK_MAKE_API_VERSION(0, 1, 1, 0);
+		version = VK_MAKE_API_VERSION(0, 1, 2, 0);
 
 		/*
 		* from vulkan_structs.hpp:
@@ -162,6 +182,12 @@ namespace vkInit {
 			extensions.push_back("VK_EXT_debug_utils");
 		}
 
+		//needed by VK_EXT_swapchain_maintenance1, which tells when presents finish
+		if (supports_surface_maintenance()) {
+			extensions.push_back(VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME);
+			extensions.push_back(VK_EXT_SURFACE_MAINTENANCE_1_EXTENSION_NAME);
+		}
+
 		vkLogging::Logger::get_logger()->print("extensions to be requested:");
 		if (vkLogging::Logger::get_logger()->get_debug_mode()) {
 
@@ -13,9 +13,11 @@ namespace vkInit {
 		vk::Device device;
 		std::string vertexFilepath;
 		std::string fragmentFilepath;
-		vk::Extent2D swapchainExtent;
 		vk::Format swapchainImageFormat, depthFormat;
 		std::vector<vk::DescriptorSetLayout> descriptorSetLayouts;
+		std::vector<vk::PushConstantRange> pushConstantRanges;
+		//may be null
+		vk::PipelineCache pipelineCache;
 	};
 
 	/**
@@ -36,6 +38,33 @@ namespace vkInit {
 	*/
 	GraphicsPipelineOutBundle create_graphics_pipeline(GraphicsPipelineInBundle& specification);
 
+	/*
+		holds the data structures used to create a compute pipeline
+	*/
+	struct ComputePipelineInBundle {
+		vk::Device device;
+		std::string computeFilepath;
+		std::vector<vk::DescriptorSetLayout> descriptorSetLayouts;
+		//may be null
+		vk::PipelineCache pipelineCache;
+	};
+
+	/**
+		Used for returning the compute pipeline and its layout after creation.
+	*/
+	struct ComputePipelineOutBundle {
+		vk::PipelineLayout layout;
+		vk::Pipeline pipeline;
+	};
+
+	/**
+		Make a compute pipeline, along with its pipeline layout
+
+		\param specification the struct holding input data
+		\returns the bundle of data structures created
+	*/
+	ComputePipelineOutBundle create_compute_pipeline(ComputePipelineInBundle& specification);
+
 	/**
 		Configure the vertex input stage.
 
@@ -64,29 +93,38 @@ namespace vkInit {
 		const vk::ShaderModule& shaderModule, const vk::ShaderStageFlagBits& stage);
 
 	/**
-		Create a viewport.
+		Create a viewport covering a whole image, set when drawing
+		since the pipeline leaves it dynamic.
 
-		\param specification holds relevant data fields
+		\param extent the size of the image being drawn to
 		\returns the created viewport
 	*/
-	vk::Viewport make_viewport(const GraphicsPipelineInBundle& specification);
+	vk::Viewport make_viewport(vk::Extent2D extent);
 
 	/**
-		Create a scissor rectangle.
+		Create a scissor rectangle covering a whole image, set when drawing
+		since the pipeline leaves it dynamic.
 
-		\param specification holds relevant data fields
+		\param extent the size of the image being drawn to
 		\returns the created rectangle
 	*/
-	vk::Rect2D make_scissor(const GraphicsPipelineInBundle& specification);
+	vk::Rect2D make_scissor(vk::Extent2D extent);
 
 	/**
-		Configure the pipeline's viewport stage.
+		Configure the pipeline's viewport stage with one viewport and scissor,
+		both dynamic so the pipeline doesn't depend on the swapchain's size.
 
-		\param viewport the viewport specification
-		\param scissor the scissor rectangle to apply
 		\returns the viewport state creation info
 	*/
-	vk::PipelineViewportStateCreateInfo make_viewport_state(const vk::Viewport& viewport, const vk::Rect2D& scissor);
+	vk::PipelineViewportStateCreateInfo make_viewport_state();
+
+	/**
+		Configure which parts of the pipeline's state are set while recording.
+
+		\param dynamicStates the states left dynamic
+		\returns the dynamic state creation info
+	*/
+	vk::PipelineDynamicStateCreateInfo make_dynamic_state_info(const std::vector<vk::DynamicState>& dynamicStates);
 
 	/**
 		\returns the creation info for the configured rasterizer stage
@@ -114,9 +152,12 @@ namespace vkInit {
 		push constants and descriptor set layouts which will be used.
 
 		\param device the logical device
+		\param descriptorSetLayouts the layouts of the sets, in set order
+		\param pushConstantRanges the push constants, if any
 		\returns the created pipeline layout
 	*/
-	vk::PipelineLayout make_pipeline_layout(vk::Device device, std::vector<vk::DescriptorSetLayout> descriptorSetLayouts);
+	vk::PipelineLayout make_pipeline_layout(vk::Device device, std::vector<vk::DescriptorSetLayout> descriptorSetLayouts,
+		const std::vector<vk::PushConstantRange>& pushConstantRanges = {});
 
 	/**
 		\returns the created push constant range
@@ -201,11 +242,12 @@ namespace vkInit {
 		vk::PipelineShaderStageCreateInfo vertexShaderInfo = make_shader_info(vertexShader, vk::ShaderStageFlagBits::eVertex);
 		shaderStages.push_back(vertexShaderInfo);
 
-		//Viewport and Scissor
-		vk::Viewport viewport = make_viewport(specification);
-		vk::Rect2D scissor = make_scissor(specification);
-		vk::PipelineViewportStateCreateInfo viewportState = make_viewport_state(viewport, scissor);
+		//Viewport and Scissor, set while recording so resizing keeps the pipeline
+		vk::PipelineViewportStateCreateInfo viewportState = make_viewport_state();
 		pipelineInfo.pViewportState = &viewportState;
+		std::vector<vk::DynamicState> dynamicStates = { vk::DynamicState::eViewport, vk::DynamicState::eScissor };
+		vk::PipelineDynamicStateCreateInfo dynamicState = make_dynamic_state_info(dynamicStates);
+		pipelineInfo.pDynamicState = &dynamicState;
 
 		//Rasterizer
 		vk::PipelineRasterizationStateCreateInfo rasterizer = make_rasterizer_info();
@@ -243,7 +285,9 @@ namespace vkInit {
 
 		//Pipeline Layout
 		vkLogging::Logger::get_logger()->print("Create Pipeline Layout");
-		vk::PipelineLayout pipelineLayout = make_pipeline_layout(specification.device, specification.descriptorSetLayouts);
+		vk::PipelineLayout pipelineLayout = make_pipeline_layout(
+			specification.device, specification.descriptorSetLayouts, specification.pushConstantRanges
+		);
 		pipelineInfo.layout = pipelineLayout;
 
 		//Renderpass
@@ -261,7 +305,7 @@ namespace vkInit {
 		vkLogging::Logger::get_logger()->print("Create Graphics Pipeline");
 		vk::Pipeline graphicsPipeline;
 		try {
-			graphicsPipeline = (specification.device.createGraphicsPipeline(nullptr, pipelineInfo)).value;
+			graphicsPipeline = (specification.device.createGraphicsPipeline(specification.pipelineCache, pipelineInfo)).value;
 		}
 		catch (vk::SystemError err) {
 			vkLogging::Logger::get_logger()->print("Failed to create Pipeline");
@@ -311,41 +355,51 @@ namespace vkInit {
 		return shaderInfo;
 	}
 
-	vk::Viewport make_viewport(const GraphicsPipelineInBundle& specification) {
+	vk::Viewport make_viewport(vk::Extent2D extent) {
 
 		vk::Viewport viewport = {};
 		viewport.x = 0.0f;
 		viewport.y = 0.0f;
-		viewport.width = (float)specification.swapchainExtent.width;
-		viewport.height = (float)specification.swapchainExtent.height;
+		viewport.width = (float)extent.width;
+		viewport.height = (float)extent.height;
 		viewport.minDepth = 0.0f;
 		viewport.maxDepth = 1.0f;
 
 		return viewport;
 	}
 
-	vk::Rect2D make_scissor(const GraphicsPipelineInBundle& specification) {
+	vk::Rect2D make_scissor(vk::Extent2D extent) {
 
 		vk::Rect2D scissor = {};
-		scissor.offset.x = 0.0f;
-		scissor.offset.y = 0.0f;
-		scissor.extent = specification.swapchainExtent;
+		scissor.offset.x = 0;
+		scissor.offset.y = 0;
+		scissor.extent = extent;
 
 		return scissor;
 	}
 
-	vk::PipelineViewportStateCreateInfo make_viewport_state(const vk::Viewport& viewport, const vk::Rect2D& scissor) {
+	vk::PipelineViewportStateCreateInfo make_viewport_state() {
 
 		vk::PipelineViewportStateCreateInfo viewportState = {};
 		viewportState.flags = vk::PipelineViewportStateCreateFlags();
 		viewportState.viewportCount = 1;
-		viewportState.pViewports = &viewport;
+		viewportState.pViewports = nullptr;
 		viewportState.scissorCount = 1;
-		viewportState.pScissors = &scissor;
+		viewportState.pScissors = nullptr;
 
 		return viewportState;
 	}
 
+	vk::PipelineDynamicStateCreateInfo make_dynamic_state_info(const std::vector<vk::DynamicState>& dynamicStates) {
+
+		vk::PipelineDynamicStateCreateInfo dynamicState = {};
+		dynamicState.flags = vk::PipelineDynamicStateCreateFlags();
+		dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+		dynamicState.pDynamicStates = dynamicStates.data();
+
+		return dynamicState;
+	}
+
 	vk::PipelineRasterizationStateCreateInfo make_rasterizer_info() {
 
 		vk::PipelineRasterizationStateCreateInfo rasterizer = {};
@@ -396,7 +450,8 @@ namespace vkInit {
 		return colorBlending;
 	}
 
-	vk::PipelineLayout make_pipeline_layout(vk::Device device, std::vector<vk::DescriptorSetLayout> descriptorSetLayouts) {
+	vk::PipelineLayout make_pipeline_layout(vk::Device device, std::vector<vk::DescriptorSetLayout> descriptorSetLayouts,
+		const std::vector<vk::PushConstantRange>& pushConstantRanges) {
 
 		vk::PipelineLayoutCreateInfo layoutInfo;
 		layoutInfo.flags = vk::PipelineLayoutCreateFlags();
@@ -404,7 +459,8 @@ namespace vkInit {
 		layoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
 		layoutInfo.pSetLayouts = descriptorSetLayouts.data();
 
-		layoutInfo.pushConstantRangeCount = 0;
+		layoutInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+		layoutInfo.pPushConstantRanges = pushConstantRanges.data();
 
 		try {
 			return device.createPipelineLayout(layoutInfo);
@@ -527,4 +583,42 @@ namespace vkInit {
 		return renderpassInfo;
 	}
 
+	ComputePipelineOutBundle create_compute_pipeline(ComputePipelineInBundle& specification) {
+
+		vk::ComputePipelineCreateInfo pipelineInfo = {};
+		pipelineInfo.flags = vk::PipelineCreateFlags();
+
+		//Compute Shader
+		vkLogging::Logger::get_logger()->print("Create compute shader module");
+		vk::ShaderModule computeShader = vkUtil::createModule(
+			specification.computeFilepath, specification.device
+		);
+		pipelineInfo.stage = make_shader_info(computeShader, vk::ShaderStageFlagBits::eCompute);
+
+		//Pipeline Layout
+		vkLogging::Logger::get_logger()->print("Create Compute Pipeline Layout");
+		vk::PipelineLayout pipelineLayout = make_pipeline_layout(specification.device, specification.descriptorSetLayouts);
+		pipelineInfo.layout = pipelineLayout;
+
+		pipelineInfo.basePipelineHandle = nullptr;
+
+		//Make the Pipeline
+		vkLogging::Logger::get_logger()->print("Create Compute Pipeline");
+		vk::Pipeline computePipeline;
+		try {
+			computePipeline = (specification.device.createComputePipeline(specification.pipelineCache, pipelineInfo)).value;
+		}
+		catch (vk::SystemError err) {
+			vkLogging::Logger::get_logger()->print("Failed to create Compute Pipeline");
+		}
+
+		ComputePipelineOutBundle output;
+		output.layout = pipelineLayout;
+		output.pipeline = computePipeline;
+
+		specification.device.destroyShaderModule(computeShader);
+
+		return output;
+	}
+
 }
\ No newline at end of file
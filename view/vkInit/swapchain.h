@@ -194,9 +194,12 @@ namespace vkInit {
 		\param surface the window surface to use the swapchain with
 		\param width the requested width
 		\param height the requested height
+		\param oldSwapchain the swapchain being replaced, if any. It's retired but
+			not destroyed, its images may still be presented until it is.
 		\returns a struct holding the swapchain and other associated data structures
 	*/
-	SwapChainBundle create_swapchain(vk::Device logicalDevice, vk::PhysicalDevice physicalDevice, vk::SurfaceKHR surface, int width, int height) {
+	SwapChainBundle create_swapchain(vk::Device logicalDevice, vk::PhysicalDevice physicalDevice, vk::SurfaceKHR surface, int width, int height,
+		vk::SwapchainKHR oldSwapchain = nullptr) {
 
 		SwapChainSupportDetails support = query_swapchain_support(physicalDevice, surface);
 
@@ -255,7 +258,7 @@ namespace vkInit {
 		createInfo.presentMode = presentMode;
 		createInfo.clipped = VK_TRUE;
 
-		createInfo.oldSwapchain = vk::SwapchainKHR(nullptr);
+		createInfo.oldSwapchain = oldSwapchain;
 
 		SwapChainBundle bundle{};
 		try {
@@ -271,7 +274,7 @@ namespace vkInit {
 		for (size_t i = 0; i < images.size(); ++i) {
 
 			bundle.frames[i].image = images[i];
-			bundle.frames[i].imageView = vkImage::make_image_view(logicalDevice, images[i], format.format, vk::ImageAspectFlagBits::eColor);
+			bundle.frames[i].imageView = vkImage::make_image_view(logicalDevice, images[i], format.format, vk::ImageAspectFlagBits::eColor, 1);
 		}
 
 		bundle.format = format.format;
@@ -27,7 +27,7 @@ namespace vkInit {
 		Make a fence.
 
 		\param device the logical device
-		\returns the created fence
+		\returns the created fence, already signaled
 	*/
 	vk::Fence make_fence(vk::Device device) {
 
@@ -42,4 +42,31 @@ namespace vkInit {
 			return nullptr;
 		}
 	}
+
+	/**
+		Make a timeline semaphore, a counter submissions signal
+		increasing values on and the host can wait for.
+
+		\param device the logical device
+		\param initialValue the semaphore's starting value
+		\returns the created semaphore
+	*/
+	vk::Semaphore make_timeline_semaphore(vk::Device device, uint64_t initialValue = 0) {
+
+		vk::SemaphoreTypeCreateInfo typeInfo = {};
+		typeInfo.semaphoreType = vk::SemaphoreType::eTimeline;
+		typeInfo.initialValue = initialValue;
+
+		vk::SemaphoreCreateInfo semaphoreInfo = {};
+		semaphoreInfo.flags = vk::SemaphoreCreateFlags();
+		semaphoreInfo.pNext = &typeInfo;
+
+		try {
+			return device.createSemaphore(semaphoreInfo);
+		}
+		catch (vk::SystemError err) {
+			vkLogging::Logger::get_logger()->print("Failed to create timeline semaphore ");
+			return nullptr;
+		}
+	}
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include "../../config.h"
+#include "../../model/packed_vertex.h"
 
 namespace vkMesh {
 
@@ -18,9 +19,9 @@ namespace vkMesh {
 
 		vk::VertexInputBindingDescription bindingDescription;
 		bindingDescription.binding = 0;
-		// x y r g b u v
-		// bindingDescription.stride = 5 * sizeof(float);
-		bindingDescription.stride = 7 * sizeof(float);
+		// x y r g b u v, quantized
+		// bindingDescription.stride = 7 * sizeof(float);
+		bindingDescription.stride = sizeof(PackedVertex);
 		bindingDescription.inputRate = vk::VertexInputRate::eVertex;
 		
 		return bindingDescription;
@@ -45,20 +46,20 @@ namespace vkMesh {
 		// Position
 		attributes[0].binding = 0;
 		attributes[0].location = 0;
-		attributes[0].format = vk::Format::eR32G32Sfloat;
-		attributes[0].offset = 0;
+		attributes[0].format = vk::Format::eR16G16Sfloat;
+		attributes[0].offset = offsetof(PackedVertex, position);
 
 		//Color
 		attributes[1].binding = 0;
 		attributes[1].location = 1;
-		attributes[1].format = vk::Format::eR32G32B32Sfloat;
-		attributes[1].offset = 2 * sizeof(float);
+		attributes[1].format = vk::Format::eR8G8B8A8Unorm;
+		attributes[1].offset = offsetof(PackedVertex, color);
 
 		//TexCoord
 		attributes[2].binding = 0;
 		attributes[2].location = 2;
-		attributes[2].format = vk::Format::eR32G32Sfloat;
-		attributes[2].offset = 5 * sizeof(float);
+		attributes[2].format = vk::Format::eR16G16Unorm;
+		attributes[2].offset = offsetof(PackedVertex, texCoord);
 
 		
 
@@ -0,0 +1,184 @@
+#include "allocator.h"
+#include "memory.h"
+#include "../../control/logging.h"
+#include <algorithm>
+
+vkUtil::MemoryAllocator::MemoryAllocator(vk::Device logicalDevice, vk::PhysicalDevice physicalDevice, vk::DeviceSize blockSize)
+	: logicalDevice{ logicalDevice }, physicalDevice{ physicalDevice }, blockSize{ blockSize }
+{
+	memoryProperties = physicalDevice.getMemoryProperties();
+}
+
+vkUtil::MemoryAllocator::~MemoryAllocator()
+{
+	for (auto& [key, blocks] : pools) {
+		for (Block& block : blocks) {
+			release_block(block);
+		}
+	}
+}
+
+MemoryAllocation vkUtil::MemoryAllocator::allocate(const vk::MemoryRequirements& requirements, vk::MemoryPropertyFlags properties, bool linear)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	uint32_t memoryTypeIndex = findMemoryTypeIndex(physicalDevice, requirements.memoryTypeBits, properties);
+	std::vector<Block>& blocks = pools[memoryTypeIndex * 2 + (linear ? 1 : 0)];
+
+	MemoryAllocation allocation;
+	allocation.size = requirements.size;
+	allocation.memoryTypeIndex = memoryTypeIndex;
+	allocation.linear = linear;
+
+	/*
+	* Anything bigger than half a block would waste most of
+	* the block it lands in, so give it its own allocation.
+	*/
+	if (requirements.size > blockSize / 2) {
+		blocks.push_back(make_block(memoryTypeIndex, requirements.size, true));
+		Block& block = blocks.back();
+		block.freeRanges.clear();
+		allocation.memory = block.memory;
+		allocation.offset = 0;
+		allocation.mappedData = block.mappedData;
+		return allocation;
+	}
+
+	for (Block& block : blocks) {
+		vk::DeviceSize offset;
+		if (!block.dedicated && place(block, requirements.size, requirements.alignment, offset)) {
+			allocation.memory = block.memory;
+			allocation.offset = offset;
+			allocation.mappedData = block.mappedData ? static_cast<char*>(block.mappedData) + offset : nullptr;
+			return allocation;
+		}
+	}
+
+	blocks.push_back(make_block(memoryTypeIndex, blockSize, false));
+	Block& block = blocks.back();
+	vk::DeviceSize offset;
+	place(block, requirements.size, requirements.alignment, offset);
+	allocation.memory = block.memory;
+	allocation.offset = offset;
+	allocation.mappedData = block.mappedData ? static_cast<char*>(block.mappedData) + offset : nullptr;
+	return allocation;
+}
+
+void vkUtil::MemoryAllocator::free(MemoryAllocation& allocation)
+{
+	if (!allocation.memory) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	std::vector<Block>& blocks = pools[allocation.memoryTypeIndex * 2 + (allocation.linear ? 1 : 0)];
+
+	for (size_t i = 0; i < blocks.size(); ++i) {
+
+		Block& block = blocks[i];
+		if (block.memory != allocation.memory) {
+			continue;
+		}
+
+		if (block.dedicated) {
+			release_block(block);
+			blocks.erase(blocks.begin() + i);
+			break;
+		}
+
+		//insert the range in offset order, then merge it with its neighbours
+		auto next = std::find_if(block.freeRanges.begin(), block.freeRanges.end(),
+			[&](const FreeRange& range) { return range.offset > allocation.offset; });
+		next = block.freeRanges.insert(next, { allocation.offset, allocation.size });
+
+		if (next + 1 != block.freeRanges.end() && next->offset + next->size == (next + 1)->offset) {
+			next->size += (next + 1)->size;
+			block.freeRanges.erase(next + 1);
+		}
+		if (next != block.freeRanges.begin() && (next - 1)->offset + (next - 1)->size == next->offset) {
+			(next - 1)->size += next->size;
+			block.freeRanges.erase(next);
+		}
+
+		//one empty block is kept so freeing and reallocating doesn't go to the driver each time
+		if (is_empty(block) && std::count_if(blocks.begin(), blocks.end(), is_empty) > 1) {
+			release_block(block);
+			blocks.erase(blocks.begin() + i);
+		}
+		break;
+	}
+
+	allocation = MemoryAllocation{};
+}
+
+vkUtil::MemoryAllocator::Block vkUtil::MemoryAllocator::make_block(uint32_t memoryTypeIndex, vk::DeviceSize size, bool dedicated)
+{
+	vk::MemoryAllocateInfo allocInfo;
+	allocInfo.allocationSize = size;
+	allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+	Block block;
+	block.memory = logicalDevice.allocateMemory(allocInfo);
+	block.size = size;
+	block.dedicated = dedicated;
+	block.freeRanges.push_back({ 0, size });
+
+	//host visible blocks stay mapped for their whole lifetime
+	block.mappedData = nullptr;
+	if (memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible) {
+		block.mappedData = logicalDevice.mapMemory(block.memory, 0, VK_WHOLE_SIZE);
+	}
+
+	//dedicated allocations are too frequent to be worth logging
+	if (!dedicated && vkLogging::Logger::get_logger()->get_debug_mode()) {
+		std::stringstream message;
+		message << "Allocated a " << size << " byte memory block of type " << memoryTypeIndex;
+		vkLogging::Logger::get_logger()->print(message.str());
+	}
+
+	return block;
+}
+
+void vkUtil::MemoryAllocator::release_block(Block& block)
+{
+	if (block.mappedData) {
+		logicalDevice.unmapMemory(block.memory);
+	}
+	logicalDevice.freeMemory(block.memory);
+}
+
+bool vkUtil::MemoryAllocator::is_empty(const Block& block)
+{
+	return !block.dedicated && block.freeRanges.size() == 1
+		&& block.freeRanges[0].offset == 0 && block.freeRanges[0].size == block.size;
+}
+
+bool vkUtil::MemoryAllocator::place(Block& block, vk::DeviceSize size, vk::DeviceSize alignment, vk::DeviceSize& offset)
+{
+	alignment = std::max<vk::DeviceSize>(alignment, 1);
+
+	for (size_t i = 0; i < block.freeRanges.size(); ++i) {
+
+		FreeRange range = block.freeRanges[i];
+		vk::DeviceSize alignedOffset = (range.offset + alignment - 1) / alignment * alignment;
+		if (alignedOffset + size > range.offset + range.size) {
+			continue;
+		}
+
+		//whatever is left on either side of the placed range stays free
+		vk::DeviceSize tail = range.offset + range.size - (alignedOffset + size);
+		block.freeRanges.erase(block.freeRanges.begin() + i);
+		if (tail > 0) {
+			block.freeRanges.insert(block.freeRanges.begin() + i, { alignedOffset + size, tail });
+		}
+		if (alignedOffset > range.offset) {
+			block.freeRanges.insert(block.freeRanges.begin() + i, { range.offset, alignedOffset - range.offset });
+		}
+
+		offset = alignedOffset;
+		return true;
+	}
+
+	return false;
+}
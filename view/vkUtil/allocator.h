@@ -0,0 +1,86 @@
+#pragma once
+#include "../../config.h"
+#include <mutex>
+
+namespace vkUtil {
+
+	/**
+		Sub-allocates device memory out of large blocks, one list of
+		blocks per memory type, so that buffers and images don't each
+		cost a driver allocation.
+
+		Buffers (linear) and optimally tiled images are placed in separate
+		blocks, so neighbouring ranges can never violate bufferImageGranularity.
+
+		Blocks which become empty are given back to the driver, except one per
+		list which is kept for the next allocation.
+	*/
+	class MemoryAllocator {
+	public:
+
+		/**
+			Make a memory allocator.
+
+			\param logicalDevice the logical device to allocate from
+			\param physicalDevice the physical device, used to query memory types
+			\param blockSize the size of each block requested from the driver
+		*/
+		MemoryAllocator(vk::Device logicalDevice, vk::PhysicalDevice physicalDevice,
+			vk::DeviceSize blockSize = 64 * 1024 * 1024);
+
+		~MemoryAllocator();
+
+		/**
+			Find a range satisfying the given requirements.
+
+			\param requirements size, alignment and supported memory types of the resource
+			\param properties properties which the memory type must satisfy
+			\param linear whether the memory is for a buffer (or linearly tiled image)
+			\returns the allocated range
+		*/
+		MemoryAllocation allocate(const vk::MemoryRequirements& requirements,
+			vk::MemoryPropertyFlags properties, bool linear);
+
+		/**
+			Return a range to its block.
+
+			\param allocation the range to release, it is reset afterwards
+		*/
+		void free(MemoryAllocation& allocation);
+
+	private:
+
+		struct FreeRange {
+			vk::DeviceSize offset;
+			vk::DeviceSize size;
+		};
+
+		struct Block {
+			vk::DeviceMemory memory;
+			vk::DeviceSize size;
+			void* mappedData;
+			//sorted by offset, neighbours are always merged
+			std::vector<FreeRange> freeRanges;
+			//holds a single resource, released as soon as that is freed
+			bool dedicated;
+		};
+
+		vk::Device logicalDevice;
+		vk::PhysicalDevice physicalDevice;
+		vk::PhysicalDeviceMemoryProperties memoryProperties;
+		vk::DeviceSize blockSize;
+		std::mutex mutex;
+
+		//keyed by memory type index * 2 + linear
+		std::unordered_map<uint32_t, std::vector<Block>> pools;
+
+		Block make_block(uint32_t memoryTypeIndex, vk::DeviceSize size, bool dedicated);
+
+		void release_block(Block& block);
+
+		//whether nothing is allocated from a shared block
+		static bool is_empty(const Block& block);
+
+		bool place(Block& block, vk::DeviceSize size, vk::DeviceSize alignment, vk::DeviceSize& offset);
+	};
+}
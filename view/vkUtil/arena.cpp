@@ -0,0 +1,87 @@
+#include "arena.h"
+#include "../../control/logging.h"
+#include <algorithm>
+
+vkUtil::FrameArena::FrameArena(vk::Device logicalDevice, vk::PhysicalDevice physicalDevice, MemoryAllocator* allocator, vk::DeviceSize capacity)
+	: capacity{ capacity }, logicalDevice{ logicalDevice }, physicalDevice{ physicalDevice }, allocator{ allocator }
+{
+	make_buffer();
+
+	vk::PhysicalDeviceLimits limits = physicalDevice.getProperties().limits;
+	uniformAlignment = limits.minUniformBufferOffsetAlignment;
+	storageAlignment = limits.minStorageBufferOffsetAlignment;
+
+	head = 0;
+}
+
+vkUtil::FrameArena::~FrameArena()
+{
+	destroyBuffer(logicalDevice, allocator, buffer);
+}
+
+vkUtil::ArenaAllocation vkUtil::FrameArena::allocate_uniform(vk::DeviceSize size)
+{
+	return allocate(size, uniformAlignment);
+}
+
+vkUtil::ArenaAllocation vkUtil::FrameArena::allocate_storage(vk::DeviceSize size)
+{
+	return allocate(size, storageAlignment);
+}
+
+void vkUtil::FrameArena::reset()
+{
+	head = 0;
+}
+
+bool vkUtil::FrameArena::reserve(vk::DeviceSize size, uint32_t blockCount)
+{
+	vk::DeviceSize required = size + blockCount * std::max(uniformAlignment, storageAlignment);
+	if (required <= capacity) {
+		return false;
+	}
+
+	std::stringstream message;
+	message << "Growing frame arena from " << capacity << " to ";
+	capacity = std::max(capacity * 2, required);
+	message << capacity << " bytes";
+	vkLogging::Logger::get_logger()->print(message.str());
+
+	//the frame's fence has been waited on, so nothing still reads the old buffer
+	destroyBuffer(logicalDevice, allocator, buffer);
+	make_buffer();
+
+	return true;
+}
+
+vkUtil::ArenaAllocation vkUtil::FrameArena::allocate(vk::DeviceSize size, vk::DeviceSize alignment)
+{
+	vk::DeviceSize offset = (head + alignment - 1) / alignment * alignment;
+
+	if (offset + size > capacity) {
+		std::stringstream message;
+		message << "Frame arena of " << capacity << " bytes can't fit another " << size << " bytes";
+		vkLogging::Logger::get_logger()->print(message.str());
+		throw std::runtime_error("frame arena too small");
+	}
+
+	head = offset + size;
+
+	ArenaAllocation allocation;
+	allocation.offset = offset;
+	allocation.data = static_cast<char*>(buffer.bufferMemory.mappedData) + offset;
+	return allocation;
+}
+
+void vkUtil::FrameArena::make_buffer()
+{
+	BufferInputChunk input;
+	input.logicalDevice = logicalDevice;
+	input.physicalDevice = physicalDevice;
+	input.allocator = allocator;
+	input.size = capacity;
+	input.usage = vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eStorageBuffer
+		| vk::BufferUsageFlagBits::eIndirectBuffer;
+	input.memoryProperties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+	buffer = createBuffer(input);
+}
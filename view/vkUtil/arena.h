@@ -0,0 +1,87 @@
+#pragma once
+#include "../../config.h"
+#include "memory.h"
+
+namespace vkUtil {
+
+	/**
+		A block handed out by a FrameArena.
+	*/
+	struct ArenaAllocation {
+		vk::DeviceSize offset;
+		void* data;
+	};
+
+	/**
+		One persistently mapped, host visible buffer holding everything a
+		frame writes for the GPU (camera data, instance data, ...). Blocks
+		are bump allocated and bound through dynamic descriptor offsets, the
+		whole arena is released at once after the frame's fence has signalled.
+
+		The arena grows when a frame needs more than it holds, growing
+		replaces the buffer so anything pointing at it must be updated.
+	*/
+	class FrameArena {
+	public:
+
+		/**
+			Make a frame arena.
+
+			\param logicalDevice the logical device
+			\param physicalDevice the physical device (used for offset alignments)
+			\param allocator the allocator which will back the arena
+			\param capacity the size (in bytes) of the arena
+		*/
+		FrameArena(vk::Device logicalDevice, vk::PhysicalDevice physicalDevice,
+			MemoryAllocator* allocator, vk::DeviceSize capacity);
+
+		~FrameArena();
+
+		/**
+			Reserve a block to be read as a uniform buffer.
+
+			\param size the size (in bytes) of the block
+			\returns the reserved block
+		*/
+		ArenaAllocation allocate_uniform(vk::DeviceSize size);
+
+		/**
+			Reserve a block to be read as a storage buffer.
+
+			\param size the size (in bytes) of the block
+			\returns the reserved block
+		*/
+		ArenaAllocation allocate_storage(vk::DeviceSize size);
+
+		/**
+			Release every block, the GPU must be done reading them.
+		*/
+		void reset();
+
+		/**
+			Make sure the arena can hold the given blocks, must be called
+			right after reset. The capacity at least doubles when it grows.
+
+			\param size the total size (in bytes) of the blocks
+			\param blockCount how many blocks size is split into (each may need padding)
+			\returns whether the buffer was replaced
+		*/
+		bool reserve(vk::DeviceSize size, uint32_t blockCount);
+
+		Buffer buffer;
+		vk::DeviceSize capacity;
+
+	private:
+
+		vk::Device logicalDevice;
+		vk::PhysicalDevice physicalDevice;
+		MemoryAllocator* allocator;
+
+		vk::DeviceSize head;
+		vk::DeviceSize uniformAlignment, storageAlignment;
+
+		ArenaAllocation allocate(vk::DeviceSize size, vk::DeviceSize alignment);
+
+		void make_buffer();
+	};
+}
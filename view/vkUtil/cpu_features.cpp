@@ -0,0 +1,48 @@
+#include "cpu_features.h"
+
+#ifdef VKUTIL_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace {
+
+	bool detect_avx() {
+#ifdef VKUTIL_X86
+		int info[4];
+#ifdef _MSC_VER
+		__cpuid(info, 1);
+#else
+		unsigned int a, b, c, d;
+		__cpuid(1, a, b, c, d);
+		info[2] = static_cast<int>(c);
+#endif
+		bool osxsave = info[2] & (1 << 27);
+		bool avx = info[2] & (1 << 28);
+		if (!(osxsave && avx)) {
+			return false;
+		}
+
+		//the OS must save the upper halves of the ymm registers on context switches
+#ifdef _MSC_VER
+		unsigned long long xcr0 = _xgetbv(0);
+#else
+		unsigned int xcrLow, xcrHigh;
+		__asm__("xgetbv" : "=a"(xcrLow), "=d"(xcrHigh) : "c"(0));
+		unsigned long long xcr0 = (static_cast<unsigned long long>(xcrHigh) << 32) | xcrLow;
+#endif
+		return (xcr0 & 0x6) == 0x6;
+#else
+		return false;
+#endif
+	}
+}
+
+bool vkUtil::cpu_has_avx()
+{
+	static const bool avx = detect_avx();
+	return avx;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define VKUTIL_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+//MSVC emits AVX intrinsics without needing the whole file built for AVX
+#define VKUTIL_TARGET_AVX
+#else
+#define VKUTIL_TARGET_AVX __attribute__((target("avx")))
+#endif
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#define VKUTIL_NEON
+#include <arm_neon.h>
+#endif
+
+namespace vkUtil {
+
+	/**
+		\returns whether the CPU and OS support AVX, checked once
+	*/
+	bool cpu_has_avx();
+}
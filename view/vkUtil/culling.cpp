@@ -0,0 +1,207 @@
+#include "culling.h"
+#include "cpu_features.h"
+
+/*
+* An instance is visible unless its bounding sphere lies entirely behind
+* one of the planes. The SIMD paths test a few instances against every
+* plane, then write out every lane's index but only advance past the
+* visible ones, which compacts the output without branching.
+*/
+
+namespace {
+
+	using CullKernel = uint32_t(*)(const vkUtil::Frustum&, const vkUtil::TransformBatch&, float, uint32_t, uint32_t, uint32_t*);
+
+	uint32_t cull_scalar(const vkUtil::Frustum& frustum, const vkUtil::TransformBatch& batch, float radius,
+		uint32_t first, uint32_t count, uint32_t* visible) {
+
+		uint32_t visibleCount = 0;
+		for (uint32_t i = first; i < first + count; ++i) {
+
+			float r = batch.scale[i] * radius;
+			bool inside = true;
+			for (const glm::vec4& plane : frustum.planes) {
+				float distance = plane.x * batch.x[i] + plane.y * batch.y[i] + plane.z * batch.z[i] + plane.w;
+				inside = inside && distance >= -r;
+			}
+
+			visible[visibleCount] = i;
+			visibleCount += inside ? 1 : 0;
+		}
+		return visibleCount;
+	}
+
+#ifdef VKUTIL_X86
+
+	uint32_t cull_sse(const vkUtil::Frustum& frustum, const vkUtil::TransformBatch& batch, float radius,
+		uint32_t first, uint32_t count, uint32_t* visible) {
+
+		uint32_t i = first;
+		uint32_t end = first + count;
+		uint32_t visibleCount = 0;
+		const __m128 unitRadius = _mm_set1_ps(-radius);
+
+		for (; i + 4 <= end; i += 4) {
+
+			__m128 x = _mm_loadu_ps(batch.x + i);
+			__m128 y = _mm_loadu_ps(batch.y + i);
+			__m128 z = _mm_loadu_ps(batch.z + i);
+			__m128 negativeRadius = _mm_mul_ps(_mm_loadu_ps(batch.scale + i), unitRadius);
+
+			__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (const glm::vec4& plane : frustum.planes) {
+				__m128 distance = _mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), x), _mm_mul_ps(_mm_set1_ps(plane.y), y)),
+					_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z), z), _mm_set1_ps(plane.w))
+				);
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+			}
+
+			int mask = _mm_movemask_ps(inside);
+			for (uint32_t lane = 0; lane < 4; ++lane) {
+				visible[visibleCount] = i + lane;
+				visibleCount += (mask >> lane) & 1;
+			}
+		}
+
+		return visibleCount + cull_scalar(frustum, batch, radius, i, end - i, visible + visibleCount);
+	}
+
+	VKUTIL_TARGET_AVX uint32_t cull_avx(const vkUtil::Frustum& frustum, const vkUtil::TransformBatch& batch, float radius,
+		uint32_t first, uint32_t count, uint32_t* visible) {
+
+		uint32_t i = first;
+		uint32_t end = first + count;
+		uint32_t visibleCount = 0;
+		const __m256 unitRadius = _mm256_set1_ps(-radius);
+
+		for (; i + 8 <= end; i += 8) {
+
+			__m256 x = _mm256_loadu_ps(batch.x + i);
+			__m256 y = _mm256_loadu_ps(batch.y + i);
+			__m256 z = _mm256_loadu_ps(batch.z + i);
+			__m256 negativeRadius = _mm256_mul_ps(_mm256_loadu_ps(batch.scale + i), unitRadius);
+
+			__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+			for (const glm::vec4& plane : frustum.planes) {
+				__m256 distance = _mm256_add_ps(
+					_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.x), x), _mm256_mul_ps(_mm256_set1_ps(plane.y), y)),
+					_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.z), z), _mm256_set1_ps(plane.w))
+				);
+				inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+			}
+
+			int mask = _mm256_movemask_ps(inside);
+			for (uint32_t lane = 0; lane < 8; ++lane) {
+				visible[visibleCount] = i + lane;
+				visibleCount += (mask >> lane) & 1;
+			}
+		}
+
+		return visibleCount + cull_sse(frustum, batch, radius, i, end - i, visible + visibleCount);
+	}
+
+#endif
+
+#ifdef VKUTIL_NEON
+
+	uint32_t cull_neon(const vkUtil::Frustum& frustum, const vkUtil::TransformBatch& batch, float radius,
+		uint32_t first, uint32_t count, uint32_t* visible) {
+
+		uint32_t i = first;
+		uint32_t end = first + count;
+		uint32_t visibleCount = 0;
+		const float32x4_t unitRadius = vdupq_n_f32(-radius);
+
+		for (; i + 4 <= end; i += 4) {
+
+			float32x4_t x = vld1q_f32(batch.x + i);
+			float32x4_t y = vld1q_f32(batch.y + i);
+			float32x4_t z = vld1q_f32(batch.z + i);
+			float32x4_t negativeRadius = vmulq_f32(vld1q_f32(batch.scale + i), unitRadius);
+
+			uint32x4_t inside = vdupq_n_u32(0xFFFFFFFF);
+			for (const glm::vec4& plane : frustum.planes) {
+				float32x4_t distance = vdupq_n_f32(plane.w);
+				distance = vmlaq_n_f32(distance, x, plane.x);
+				distance = vmlaq_n_f32(distance, y, plane.y);
+				distance = vmlaq_n_f32(distance, z, plane.z);
+				inside = vandq_u32(inside, vcgeq_f32(distance, negativeRadius));
+			}
+
+			uint32_t lanes[4];
+			vst1q_u32(lanes, inside);
+			for (uint32_t lane = 0; lane < 4; ++lane) {
+				visible[visibleCount] = i + lane;
+				visibleCount += lanes[lane] & 1;
+			}
+		}
+
+		return visibleCount + cull_scalar(frustum, batch, radius, i, end - i, visible + visibleCount);
+	}
+
+#endif
+
+	struct KernelChoice {
+		CullKernel kernel;
+		const char* name;
+	};
+
+	KernelChoice choose_kernel() {
+#if defined(VKUTIL_X86)
+		if (vkUtil::cpu_has_avx()) {
+			return { cull_avx, "AVX" };
+		}
+		return { cull_sse, "SSE" };
+#elif defined(VKUTIL_NEON)
+		return { cull_neon, "NEON" };
+#else
+		return { cull_scalar, "scalar" };
+#endif
+	}
+
+	const KernelChoice& kernel_choice() {
+		static const KernelChoice choice = choose_kernel();
+		return choice;
+	}
+}
+
+vkUtil::Frustum vkUtil::make_frustum(const glm::mat4& viewProjection)
+{
+	//rows of the matrix, glm stores columns
+	glm::vec4 rows[4];
+	for (int row = 0; row < 4; ++row) {
+		rows[row] = glm::vec4(viewProjection[0][row], viewProjection[1][row], viewProjection[2][row], viewProjection[3][row]);
+	}
+
+	/*
+	* A point is inside when -w <= x <= w, -w <= y <= w and 0 <= z <= w
+	* in clip space, each inequality is one plane in world space.
+	*/
+	Frustum frustum;
+	frustum.planes[0] = rows[3] + rows[0];
+	frustum.planes[1] = rows[3] - rows[0];
+	frustum.planes[2] = rows[3] + rows[1];
+	frustum.planes[3] = rows[3] - rows[1];
+	frustum.planes[4] = rows[2];
+	frustum.planes[5] = rows[3] - rows[2];
+
+	for (glm::vec4& plane : frustum.planes) {
+		float length = glm::length(glm::vec3(plane));
+		//an infinite far plane degenerates, and culls nothing
+		plane = length > 0.0f ? plane / length : glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	}
+
+	return frustum;
+}
+
+uint32_t vkUtil::cull_spheres(const Frustum& frustum, const TransformBatch& batch, float radius,
+	uint32_t first, uint32_t count, uint32_t* visible)
+{
+	return kernel_choice().kernel(frustum, batch, radius, first, count, visible);
+}
+
+const char* vkUtil::culling_kernel_name()
+{
+	return kernel_choice().name;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "../../config.h"
+#include "transforms.h"
+
+namespace vkUtil {
+
+	/**
+		The six planes bounding what a camera can see, as (normal, distance)
+		with normals pointing inwards and normalized.
+	*/
+	struct Frustum {
+		glm::vec4 planes[6];
+	};
+
+	/**
+		What the culling compute shader needs to know about the frame,
+		laid out as shaders/cull.comp reads it.
+	*/
+	struct CullParams {
+		Frustum frustum;
+		uint32_t instanceCount;
+		uint32_t drawCount;
+		uint32_t padding[2];
+	};
+
+	/**
+		An indirect draw of one instance group. The culling compute shader
+		counts survivors into command.instanceCount and lists them from
+		command.firstInstance on, the rest tells it which instances are
+		the group's and how big they are, and what to draw them with.
+	*/
+	struct DrawCommand {
+		vk::DrawIndexedIndirectCommand command;
+		uint32_t groupSize;
+		float radius;
+		uint32_t material;
+	};
+
+	/**
+		Extract the frustum planes from a view projection matrix.
+
+		\param viewProjection the camera's view projection matrix (Vulkan clip space)
+		\returns the frustum
+	*/
+	Frustum make_frustum(const glm::mat4& viewProjection);
+
+	/**
+		Test instances' bounding spheres against a frustum and write out the
+		indices of those which are at least partly inside. Uses the widest
+		SIMD path the CPU supports (AVX, SSE or NEON) to test several
+		instances at once.
+
+		\param frustum the frustum to test against
+		\param batch the instance transforms (positions and scales are read)
+		\param radius the bounding radius of the instances' mesh at unit scale
+		\param first index of the first instance to test
+		\param count how many instances to test
+		\param visible indices of visible instances are written here, must have room for count
+		\returns how many instances are visible
+	*/
+	uint32_t cull_spheres(const Frustum& frustum, const TransformBatch& batch, float radius,
+		uint32_t first, uint32_t count, uint32_t* visible);
+
+	/**
+		\returns the name of the kernel cull_spheres runs on this CPU
+	*/
+	const char* culling_kernel_name();
+}
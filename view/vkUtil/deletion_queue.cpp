@@ -0,0 +1,90 @@
+#include "deletion_queue.h"
+
+vkUtil::DeletionQueue::DeletionQueue(vk::Device logicalDevice, MemoryAllocator* allocator)
+	: logicalDevice{ logicalDevice }, allocator{ allocator }
+{
+}
+
+vkUtil::DeletionQueue::~DeletionQueue()
+{
+	flush(UINT64_MAX);
+}
+
+void vkUtil::DeletionQueue::push(uint64_t lastUse, vk::Buffer resource)
+{
+	vk::Device device = logicalDevice;
+	push(lastUse, [device, resource]() { device.destroyBuffer(resource); });
+}
+
+void vkUtil::DeletionQueue::push(uint64_t lastUse, vk::Image resource)
+{
+	vk::Device device = logicalDevice;
+	push(lastUse, [device, resource]() { device.destroyImage(resource); });
+}
+
+void vkUtil::DeletionQueue::push(uint64_t lastUse, vk::ImageView resource)
+{
+	vk::Device device = logicalDevice;
+	push(lastUse, [device, resource]() { device.destroyImageView(resource); });
+}
+
+void vkUtil::DeletionQueue::push(uint64_t lastUse, vk::Sampler resource)
+{
+	vk::Device device = logicalDevice;
+	push(lastUse, [device, resource]() { device.destroySampler(resource); });
+}
+
+void vkUtil::DeletionQueue::push(uint64_t lastUse, vk::Framebuffer resource)
+{
+	vk::Device device = logicalDevice;
+	push(lastUse, [device, resource]() { device.destroyFramebuffer(resource); });
+}
+
+void vkUtil::DeletionQueue::push(uint64_t lastUse, vk::DescriptorPool resource)
+{
+	vk::Device device = logicalDevice;
+	push(lastUse, [device, resource]() { device.destroyDescriptorPool(resource); });
+}
+
+void vkUtil::DeletionQueue::push(uint64_t lastUse, vk::Semaphore resource)
+{
+	vk::Device device = logicalDevice;
+	push(lastUse, [device, resource]() { device.destroySemaphore(resource); });
+}
+
+void vkUtil::DeletionQueue::push(uint64_t lastUse, vk::SwapchainKHR resource)
+{
+	vk::Device device = logicalDevice;
+	push(lastUse, [device, resource]() { device.destroySwapchainKHR(resource); });
+}
+
+void vkUtil::DeletionQueue::push(uint64_t lastUse, const MemoryAllocation& memory)
+{
+	MemoryAllocator* memoryAllocator = allocator;
+	MemoryAllocation allocation = memory;
+	push(lastUse, [memoryAllocator, allocation]() mutable { memoryAllocator->free(allocation); });
+}
+
+void vkUtil::DeletionQueue::push(uint64_t lastUse, std::function<void()> destroy)
+{
+	deletions.push_back({ lastUse, std::move(destroy) });
+}
+
+void vkUtil::DeletionQueue::flush(uint64_t completed)
+{
+	if (deletions.empty()) {
+		return;
+	}
+
+	//tags aren't pushed in order, so look at every entry but keep the order of the rest
+	std::deque<Deletion> pending;
+	for (Deletion& deletion : deletions) {
+		if (deletion.lastUse <= completed) {
+			deletion.destroy();
+		}
+		else {
+			pending.push_back(std::move(deletion));
+		}
+	}
+	deletions.swap(pending);
+}
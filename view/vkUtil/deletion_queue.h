@@ -0,0 +1,74 @@
+#pragma once
+#include "../../config.h"
+#include "allocator.h"
+#include <functional>
+#include <deque>
+
+namespace vkUtil {
+
+	/**
+		Holds on to GPU resources which are no longer needed but may still be
+		used by submitted work, and destroys them once that work has finished.
+
+		Each resource is tagged with the value of the last submission which uses it,
+		on a timeline whose completed value is handed to flush (the engine's frame timeline).
+		Resources are destroyed in the order they were pushed.
+	*/
+	class DeletionQueue {
+	public:
+
+		/**
+			\param logicalDevice the device which owns the resources
+			\param allocator the allocator memory is returned to
+		*/
+		DeletionQueue(vk::Device logicalDevice, MemoryAllocator* allocator);
+
+		/**
+			Destroys everything still queued, the device must be idle.
+		*/
+		~DeletionQueue();
+
+		/**
+			Queue a resource's destruction.
+
+			\param lastUse the timeline value of the last submission using the resource
+			\param resource the resource to destroy
+		*/
+		void push(uint64_t lastUse, vk::Buffer resource);
+		void push(uint64_t lastUse, vk::Image resource);
+		void push(uint64_t lastUse, vk::ImageView resource);
+		void push(uint64_t lastUse, vk::Sampler resource);
+		void push(uint64_t lastUse, vk::Framebuffer resource);
+		void push(uint64_t lastUse, vk::DescriptorPool resource);
+		void push(uint64_t lastUse, vk::Semaphore resource);
+		void push(uint64_t lastUse, vk::SwapchainKHR resource);
+		void push(uint64_t lastUse, const MemoryAllocation& memory);
+
+		/**
+			Queue anything else, like an object holding several resources.
+
+			\param lastUse the timeline value of the last submission using it
+			\param destroy destroys it
+		*/
+		void push(uint64_t lastUse, std::function<void()> destroy);
+
+		/**
+			Destroy everything whose last use has completed.
+
+			\param completed the latest timeline value the GPU has finished
+		*/
+		void flush(uint64_t completed);
+
+	private:
+
+		struct Deletion {
+			uint64_t lastUse;
+			std::function<void()> destroy;
+		};
+
+		vk::Device logicalDevice;
+		MemoryAllocator* allocator;
+
+		std::deque<Deletion> deletions;
+	};
+}
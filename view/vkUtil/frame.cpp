@@ -1,63 +1,76 @@
 #include "frame.h"
 #include "memory.h"
+#include "culling.h"
 #include "../vkImage/image.h"
 
-void vkUtil::SwapChainFrame::make_descriptor_resources()
+void vkUtil::FrameContext::make_descriptor_resources(vk::DeviceSize arenaSize)
 {
-	BufferInputChunk input;
-	input.logicalDevice = logicalDevice;
-	input.physicalDevice = physicalDevice;
-	input.memoryProperties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
-	input.size = sizeof(UBO);
-	input.usage = vk::BufferUsageFlagBits::eUniformBuffer;
-	cameraDataBuffer = createBuffer(input);
+	arena = new FrameArena(logicalDevice, physicalDevice, allocator, arenaSize);
 
-	cameraDataWriteLocation = logicalDevice.mapMemory(cameraDataBuffer.bufferMemory, 0, sizeof(UBO));
+	uniformBufferDescriptor.buffer = arena->buffer.buffer;
+	uniformBufferDescriptor.offset = 0;
+	uniformBufferDescriptor.range = sizeof(UBO);
 
-	input.size = 1024 * sizeof(glm::mat4);
-	input.usage = vk::BufferUsageFlagBits::eStorageBuffer;
-	modelBuffer = createBuffer(input);
+	//the dynamic offset is subtracted from the whole size when binding
+	modelBufferDescriptor.buffer = arena->buffer.buffer;
+	modelBufferDescriptor.offset = 0;
+	modelBufferDescriptor.range = VK_WHOLE_SIZE;
 
-	modelBufferWriteLocation = logicalDevice.mapMemory(modelBuffer.bufferMemory, 0, 1024 * sizeof(glm::mat4));
+	visibleBufferDescriptor.buffer = arena->buffer.buffer;
+	visibleBufferDescriptor.offset = 0;
+	visibleBufferDescriptor.range = VK_WHOLE_SIZE;
 
-	modelTransforms.reserve(1024);
-	for (int i = 0; i < 1024; ++i) {
-		modelTransforms.push_back(glm::mat4(1.0f));
-	}
+	cullParamsDescriptor.buffer = arena->buffer.buffer;
+	cullParamsDescriptor.offset = 0;
+	cullParamsDescriptor.range = sizeof(CullParams);
 
-	uniformBufferDescriptor.buffer = cameraDataBuffer.buffer;
-	uniformBufferDescriptor.offset = 0;
-	uniformBufferDescriptor.range = sizeof(UBO);
+	drawCommandsDescriptor.buffer = arena->buffer.buffer;
+	drawCommandsDescriptor.offset = 0;
+	drawCommandsDescriptor.range = VK_WHOLE_SIZE;
 
-	modelBufferDescriptor.buffer = modelBuffer.buffer;
-	modelBufferDescriptor.offset = 0;
-	modelBufferDescriptor.range = 1024 * sizeof(glm::mat4);
+	transformVersion = 0;
+	transformCount = 0;
+	transformsValid = false;
+}
+
+bool vkUtil::FrameContext::begin_arena(vk::DeviceSize size, uint32_t blockCount)
+{
+	arena->reset();
+
+	if (arena->reserve(size, blockCount)) {
+		uniformBufferDescriptor.buffer = arena->buffer.buffer;
+		modelBufferDescriptor.buffer = arena->buffer.buffer;
+		visibleBufferDescriptor.buffer = arena->buffer.buffer;
+		cullParamsDescriptor.buffer = arena->buffer.buffer;
+		drawCommandsDescriptor.buffer = arena->buffer.buffer;
+		write_descriptor_set();
+		transformsValid = false;
+		return true;
+	}
+
+	return false;
 }
 
 void vkUtil::SwapChainFrame::make_depth_resources()
 {
-	depthFormat = vkImage::find_supported_format(
-		physicalDevice,
-		{ vk::Format::eD32Sfloat, vk::Format::eD24UnormS8Uint },
-		vk::ImageTiling::eOptimal,
-		vk::FormatFeatureFlagBits::eDepthStencilAttachment
-	);
 	vkImage::ImageInputChunk imageInfo;
 	imageInfo.logicalDevice = logicalDevice;
 	imageInfo.physicalDevice = physicalDevice;
+	imageInfo.allocator = allocator;
 	imageInfo.tiling = vk::ImageTiling::eOptimal;
 	imageInfo.usage = vk::ImageUsageFlagBits::eDepthStencilAttachment;
 	imageInfo.memoryProperties = vk::MemoryPropertyFlagBits::eDeviceLocal;
 	imageInfo.width = width;
 	imageInfo.height = height;
+	imageInfo.mipLevels = 1;
 	imageInfo.format = depthFormat;
 
 	depthBuffer = vkImage::make_image(imageInfo);
 	depthBufferMemory = vkImage::make_image_memory(imageInfo, depthBuffer);
-	depthBufferView = vkImage::make_image_view(logicalDevice, depthBuffer, depthFormat, vk::ImageAspectFlagBits::eDepth);
+	depthBufferView = vkImage::make_image_view(logicalDevice, depthBuffer, depthFormat, vk::ImageAspectFlagBits::eDepth, 1);
 }
 
-void vkUtil::SwapChainFrame::write_descriptor_set()
+void vkUtil::FrameContext::write_descriptor_set()
 {
 	vk::WriteDescriptorSet writeInfo1;
 
@@ -65,7 +78,7 @@ void vkUtil::SwapChainFrame::write_descriptor_set()
 	writeInfo1.dstBinding = 0;
 	writeInfo1.dstArrayElement = 0;
 	writeInfo1.descriptorCount = 1;
-	writeInfo1.descriptorType = vk::DescriptorType::eUniformBuffer;
+	writeInfo1.descriptorType = vk::DescriptorType::eUniformBufferDynamic;
 	writeInfo1.pBufferInfo = &uniformBufferDescriptor;
 
 	logicalDevice.updateDescriptorSets(writeInfo1, nullptr);
@@ -76,29 +89,74 @@ void vkUtil::SwapChainFrame::write_descriptor_set()
 	writeInfo2.dstBinding = 1;
 	writeInfo2.dstArrayElement = 0;
 	writeInfo2.descriptorCount = 1;
-	writeInfo2.descriptorType = vk::DescriptorType::eStorageBuffer;
+	writeInfo2.descriptorType = vk::DescriptorType::eStorageBufferDynamic;
 	writeInfo2.pBufferInfo = &modelBufferDescriptor;
 
 	logicalDevice.updateDescriptorSets(writeInfo2, nullptr);
+
+	vk::WriteDescriptorSet writeInfo3;
+
+	writeInfo3.dstSet = descriptorSet;
+	writeInfo3.dstBinding = 2;
+	writeInfo3.dstArrayElement = 0;
+	writeInfo3.descriptorCount = 1;
+	writeInfo3.descriptorType = vk::DescriptorType::eStorageBufferDynamic;
+	writeInfo3.pBufferInfo = &visibleBufferDescriptor;
+
+	logicalDevice.updateDescriptorSets(writeInfo3, nullptr);
+
+	vk::WriteDescriptorSet writeInfo4;
+
+	writeInfo4.dstSet = descriptorSet;
+	writeInfo4.dstBinding = 3;
+	writeInfo4.dstArrayElement = 0;
+	writeInfo4.descriptorCount = 1;
+	writeInfo4.descriptorType = vk::DescriptorType::eStorageBufferDynamic;
+	writeInfo4.pBufferInfo = &drawCommandsDescriptor;
+
+	logicalDevice.updateDescriptorSets(writeInfo4, nullptr);
+
+	if (!cullDescriptorSet) {
+		return;
+	}
+
+	std::array<vk::WriteDescriptorSet, 4> cullWrites;
+	std::array<vk::DescriptorType, 4> cullTypes = {
+		vk::DescriptorType::eUniformBufferDynamic, vk::DescriptorType::eStorageBufferDynamic,
+		vk::DescriptorType::eStorageBufferDynamic, vk::DescriptorType::eStorageBufferDynamic
+	};
+	std::array<const vk::DescriptorBufferInfo*, 4> cullBuffers = {
+		&cullParamsDescriptor, &modelBufferDescriptor, &visibleBufferDescriptor, &drawCommandsDescriptor
+	};
+	for (uint32_t i = 0; i < cullWrites.size(); ++i) {
+		cullWrites[i].dstSet = cullDescriptorSet;
+		cullWrites[i].dstBinding = i;
+		cullWrites[i].dstArrayElement = 0;
+		cullWrites[i].descriptorCount = 1;
+		cullWrites[i].descriptorType = cullTypes[i];
+		cullWrites[i].pBufferInfo = cullBuffers[i];
+	}
+
+	logicalDevice.updateDescriptorSets(cullWrites, nullptr);
 }
 
 void vkUtil::SwapChainFrame::destroy()
 {
 	logicalDevice.destroyImage(depthBuffer);
-	logicalDevice.freeMemory(depthBufferMemory);
+	allocator->free(depthBufferMemory);
 	logicalDevice.destroyImageView(depthBufferView);
 
 	logicalDevice.destroyImageView(imageView);
 	logicalDevice.destroyFramebuffer(framebuffer);
-	logicalDevice.destroyFence(inFlight);
-	logicalDevice.destroySemaphore(imageAvailable);
 	logicalDevice.destroySemaphore(renderFinished);
+}
 
-	logicalDevice.unmapMemory(cameraDataBuffer.bufferMemory);
-	logicalDevice.freeMemory(cameraDataBuffer.bufferMemory);
-	logicalDevice.destroyBuffer(cameraDataBuffer.buffer);
+void vkUtil::FrameContext::destroy()
+{
+	logicalDevice.destroySemaphore(imageAvailable);
+	if (presentFence) {
+		logicalDevice.destroyFence(presentFence);
+	}
 
-	logicalDevice.unmapMemory(modelBuffer.bufferMemory);
-	logicalDevice.freeMemory(modelBuffer.bufferMemory);
-	logicalDevice.destroyBuffer(modelBuffer.buffer);
+	delete arena;
 }
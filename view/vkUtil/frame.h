@@ -1,6 +1,7 @@
 #pragma once
 #include "../../config.h"
 #include "memory.h"
+#include "arena.h"
 
 namespace vkUtil {
 	struct UBO {
@@ -10,13 +11,26 @@ namespace vkUtil {
 	};
 
 	/**
-		Holds the data structures associated with a "Frame"
+		A draw of visible instances sharing a mesh and a material,
+		firstInstance indexes the frame's visible instance list.
+	*/
+	struct DrawRange {
+		uint32_t mesh;
+		uint32_t material;
+		uint32_t firstInstance;
+		uint32_t instanceCount;
+	};
+
+	/**
+		Holds the data structures associated with one swapchain image.
+		Everything written by the CPU lives in a FrameContext instead.
 	*/
 	class SwapChainFrame {
 	public:
 
 		vk::Device logicalDevice;
 		vk::PhysicalDevice physicalDevice;
+		MemoryAllocator* allocator;
 
 
 		// swapchain
@@ -24,35 +38,86 @@ namespace vkUtil {
 		vk::ImageView imageView;
 		vk::Framebuffer framebuffer;
 		vk::Image depthBuffer;
-		vk::DeviceMemory depthBufferMemory;
+		MemoryAllocation depthBufferMemory;
 		vk::ImageView depthBufferView;
 		vk::Format depthFormat;
 		int width, height;
 
+		// synchronization, presentation of this image waits on it
+		vk::Semaphore renderFinished;
 
-		vk::CommandBuffer commandBuffer;
+		/**
+			Make the depth buffer, sized to the frame in the format already set in depthFormat.
+		*/
+		void make_depth_resources();
 
-		// synchronization
-		vk::Semaphore imageAvailable, renderFinished;
-		vk::Fence inFlight;
+		void destroy();
 
-		// resources
-		UBO cameraData;
-		Buffer cameraDataBuffer;
-		void* cameraDataWriteLocation;
+	};
 
-		std::vector<glm::mat4> modelTransforms;
-		Buffer modelBuffer;
-		void* modelBufferWriteLocation;
+	/**
+		Holds the data structures used to record and submit one frame.
+		Frame contexts are used round robin, their count is the number
+		of frames the CPU may run ahead of the GPU.
+	*/
+	class FrameContext {
+	public:
+
+		vk::Device logicalDevice;
+		vk::PhysicalDevice physicalDevice;
+		MemoryAllocator* allocator;
+
+		vk::CommandBuffer commandBuffer;
 
-		// resource descriptors
+		// synchronization
+		vk::Semaphore imageAvailable;
+		//the frame number this context was last submitted with, on the engine's frame timeline
+		uint64_t submission;
+		//signaled when this context's last present is done, null without present fences
+		vk::Fence presentFence;
+
+		// resources, rebuilt from scratch every time the context is used
+		FrameArena* arena;
+		vk::DeviceSize cameraDataOffset;
+		vk::DeviceSize modelBufferOffset;
+		vk::DeviceSize visibleBufferOffset;
+		vk::DeviceSize cullParamsOffset;
+		vk::DeviceSize drawCommandsOffset;
+
+		//what survived culling this frame, when culling on the GPU the counts are only upper bounds
+		std::vector<DrawRange> drawRanges;
+
+		//the instance block keeps its offset, so it only needs the scene's edits since this version
+		uint64_t transformVersion;
+		size_t transformCount;
+		bool transformsValid;
+
+		// resource descriptors, bound at the offsets above
 		vk::DescriptorBufferInfo uniformBufferDescriptor;
 		vk::DescriptorBufferInfo modelBufferDescriptor;
+		vk::DescriptorBufferInfo visibleBufferDescriptor;
+		vk::DescriptorBufferInfo cullParamsDescriptor;
+		vk::DescriptorBufferInfo drawCommandsDescriptor;
 		vk::DescriptorSet descriptorSet;
+		//for the culling compute pass, null if culling runs on the CPU
+		vk::DescriptorSet cullDescriptorSet;
 
-		void make_descriptor_resources();
+		/**
+			Make the arena and point the descriptors at it.
 
-		void make_depth_resources();
+			\param arenaSize the size (in bytes) of the arena
+		*/
+		void make_descriptor_resources(vk::DeviceSize arenaSize);
+
+		/**
+			Reset the arena and make sure it can hold this frame's blocks,
+			rewriting the descriptor set if the arena had to grow.
+
+			\param size the total size (in bytes) of the blocks
+			\param blockCount how many blocks will be allocated
+			\returns whether the arena grew (discarding its contents)
+		*/
+		bool begin_arena(vk::DeviceSize size, uint32_t blockCount);
 
 		void write_descriptor_set();
 
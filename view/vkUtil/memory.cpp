@@ -1,5 +1,4 @@
 #include "memory.h"
-#include "single_time_commands.h"
 
 uint32_t vkUtil::findMemoryTypeIndex(vk::PhysicalDevice physicalDevice, uint32_t supportedMemoryIndices, vk::MemoryPropertyFlags requestedProperties) {
 
@@ -42,24 +41,8 @@ void vkUtil::allocateBufferMemory(Buffer& buffer, const BufferInputChunk& input)
 	*/
 	vk::MemoryRequirements memoryRequirements = input.logicalDevice.getBufferMemoryRequirements(buffer.buffer);
 
-	/*
-	* // Provided by VK_VERSION_1_0
-	typedef struct VkMemoryAllocateInfo {
-		VkStructureType    sType;
-		const void*        pNext;
-		VkDeviceSize       allocationSize;
-		uint32_t           memoryTypeIndex;
-	} VkMemoryAllocateInfo;
-	*/
-	vk::MemoryAllocateInfo allocInfo;
-	allocInfo.allocationSize = memoryRequirements.size;
-	allocInfo.memoryTypeIndex = findMemoryTypeIndex(
-		input.physicalDevice, memoryRequirements.memoryTypeBits,
-		input.memoryProperties
-	);
-
-	buffer.bufferMemory = input.logicalDevice.allocateMemory(allocInfo);
-	input.logicalDevice.bindBufferMemory(buffer.buffer, buffer.bufferMemory, 0);
+	buffer.bufferMemory = input.allocator->allocate(memoryRequirements, input.memoryProperties, true);
+	input.logicalDevice.bindBufferMemory(buffer.buffer, buffer.bufferMemory.memory, buffer.bufferMemory.offset);
 }
 
 Buffer vkUtil::createBuffer(BufferInputChunk input) {
@@ -90,23 +73,9 @@ Buffer vkUtil::createBuffer(BufferInputChunk input) {
 	return buffer;
 }
 
-void vkUtil::copyBuffer(Buffer& srcBuffer, Buffer& dstBuffer, vk::DeviceSize size, vk::Queue queue, vk::CommandBuffer commandBuffer) {
-
-	start_job(commandBuffer);
-
-	/*
-	* // Provided by VK_VERSION_1_0
-	typedef struct VkBufferCopy {
-		VkDeviceSize    srcOffset;
-		VkDeviceSize    dstOffset;
-		VkDeviceSize    size;
-	} VkBufferCopy;
-	*/
-	vk::BufferCopy copyRegion;
-	copyRegion.srcOffset = 0;
-	copyRegion.dstOffset = 0;
-	copyRegion.size = size;
-	commandBuffer.copyBuffer(srcBuffer.buffer, dstBuffer.buffer, 1, &copyRegion);
+void vkUtil::destroyBuffer(vk::Device logicalDevice, MemoryAllocator* allocator, Buffer& buffer) {
 
-	end_job(commandBuffer, queue);
+	logicalDevice.destroyBuffer(buffer.buffer);
+	allocator->free(buffer.bufferMemory);
+	buffer.buffer = nullptr;
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include "../../config.h"
+#include "allocator.h"
 
 namespace vkUtil {
 
@@ -32,13 +33,11 @@ namespace vkUtil {
 	Buffer createBuffer(BufferInputChunk input);
 
 	/**
-		Copy a buffer.
+		Destroy a buffer and hand its memory back to the allocator.
 
-		\param srcBuffer the buffer to copy from
-		\param dstBuffer the buffer to copy to
-		\param size the size (in bytes) to copy
-		\param queue on which to submit the job
-		\param commandBuffer the command buffer on which to record the job
+		\param logicalDevice the logical device which owns the buffer
+		\param allocator the allocator its memory came from
+		\param buffer the buffer to destroy
 	*/
-	void copyBuffer(Buffer& srcBuffer, Buffer& dstBuffer, vk::DeviceSize size, vk::Queue queue, vk::CommandBuffer commandBuffer);
+	void destroyBuffer(vk::Device logicalDevice, MemoryAllocator* allocator, Buffer& buffer);
 }
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include "pipeline_cache.h"
+#include "../../control/logging.h"
+#include <cstring>
+#include <filesystem>
+
+namespace {
+
+	/**
+		The header every pipeline cache's data starts with (VK_PIPELINE_CACHE_HEADER_VERSION_ONE)
+	*/
+	struct CacheHeader {
+		uint32_t headerSize;
+		uint32_t headerVersion;
+		uint32_t vendorID;
+		uint32_t deviceID;
+		uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+	};
+	static_assert(sizeof(CacheHeader) == 32, "pipeline cache header is 32 bytes");
+}
+
+vkUtil::PipelineCache::PipelineCache(vk::Device logicalDevice, vk::PhysicalDevice physicalDevice, const std::string& filename)
+	: logicalDevice{ logicalDevice }, filename{ filename }
+{
+	properties = physicalDevice.getProperties();
+
+	std::vector<char> data;
+	std::ifstream file(filename, std::ios::binary | std::ios::ate);
+	if (file.is_open()) {
+		data.resize(static_cast<size_t>(file.tellg()));
+		file.seekg(0);
+		if (!file.read(data.data(), data.size())) {
+			data.clear();
+		}
+	}
+
+	if (data.empty()) {
+		vkLogging::Logger::get_logger()->print("No pipeline cache found, pipelines will be built from scratch");
+	}
+	else if (!is_compatible(data)) {
+		vkLogging::Logger::get_logger()->print("Pipeline cache was made for another device or driver, ignoring it");
+		data.clear();
+	}
+	else {
+		vkLogging::Logger::get_logger()->print("Loaded pipeline cache from " + filename);
+	}
+
+	vk::PipelineCacheCreateInfo cacheInfo = {};
+	cacheInfo.flags = vk::PipelineCacheCreateFlags();
+	cacheInfo.initialDataSize = data.size();
+	cacheInfo.pInitialData = data.data();
+
+	try {
+		cache = logicalDevice.createPipelineCache(cacheInfo);
+	}
+	catch (vk::SystemError err) {
+		//the driver may still reject data it wrote, start empty in that case
+		vkLogging::Logger::get_logger()->print("Failed to load pipeline cache data, starting empty");
+		cacheInfo.initialDataSize = 0;
+		cacheInfo.pInitialData = nullptr;
+		cache = logicalDevice.createPipelineCache(cacheInfo);
+	}
+}
+
+vkUtil::PipelineCache::~PipelineCache()
+{
+	logicalDevice.destroyPipelineCache(cache);
+}
+
+vk::PipelineCache vkUtil::PipelineCache::make_worker_cache()
+{
+	//seeded with what's cached so far, so the worker still finds pipelines loaded from disk
+	std::vector<uint8_t> data;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		data = logicalDevice.getPipelineCacheData(cache);
+	}
+
+	vk::PipelineCacheCreateInfo cacheInfo = {};
+	cacheInfo.flags = vk::PipelineCacheCreateFlags();
+	cacheInfo.initialDataSize = data.size();
+	cacheInfo.pInitialData = data.data();
+	return logicalDevice.createPipelineCache(cacheInfo);
+}
+
+void vkUtil::PipelineCache::merge(vk::PipelineCache workerCache)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		try {
+			logicalDevice.mergePipelineCaches(cache, workerCache);
+		}
+		catch (vk::SystemError err) {
+			vkLogging::Logger::get_logger()->print("Failed to merge pipeline cache");
+		}
+	}
+	logicalDevice.destroyPipelineCache(workerCache);
+}
+
+void vkUtil::PipelineCache::save()
+{
+	std::vector<uint8_t> data;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		data = logicalDevice.getPipelineCacheData(cache);
+	}
+
+	std::string temporary = filename + ".tmp";
+	{
+		std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+		if (!file.write(reinterpret_cast<const char*>(data.data()), data.size())) {
+			vkLogging::Logger::get_logger()->print("Failed to write pipeline cache");
+			return;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporary, filename, error);
+	if (error) {
+		vkLogging::Logger::get_logger()->print("Failed to replace pipeline cache: " + error.message());
+		std::filesystem::remove(temporary, error);
+		return;
+	}
+
+	vkLogging::Logger::get_logger()->print("Saved pipeline cache to " + filename);
+}
+
+bool vkUtil::PipelineCache::is_compatible(const std::vector<char>& data)
+{
+	if (data.size() < sizeof(CacheHeader)) {
+		return false;
+	}
+
+	CacheHeader header;
+	std::memcpy(&header, data.data(), sizeof(CacheHeader));
+
+	return header.headerSize >= sizeof(CacheHeader)
+		&& header.headerSize <= data.size()
+		&& header.headerVersion == static_cast<uint32_t>(vk::PipelineCacheHeaderVersion::eOne)
+		&& header.vendorID == properties.vendorID
+		&& header.deviceID == properties.deviceID
+		&& std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID.data(), VK_UUID_SIZE) == 0;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include "../../config.h"
+#include <mutex>
+
+namespace vkUtil {
+
+	/**
+		The engine's pipeline cache, kept on disk between runs so pipelines
+		built before don't have their shaders compiled again.
+
+		Pipelines may be created with it from any thread. Threads which build
+		many pipelines can instead fill a cache of their own (make_worker_cache)
+		and merge it back once they're done.
+	*/
+	class PipelineCache {
+	public:
+
+		/**
+			Make the pipeline cache, starting from the file's contents if it was
+			written for this device (same vendor, device and cache UUID).
+
+			\param logicalDevice the logical device
+			\param physicalDevice the physical device the cache must match
+			\param filename where the cache is loaded from and saved to
+		*/
+		PipelineCache(vk::Device logicalDevice, vk::PhysicalDevice physicalDevice, const std::string& filename);
+
+		~PipelineCache();
+
+		/**
+			\returns a copy of the cache for one thread to build pipelines with, hand it back with merge
+		*/
+		vk::PipelineCache make_worker_cache();
+
+		/**
+			Merge a worker's cache into this one and destroy it.
+
+			\param workerCache a cache returned by make_worker_cache
+		*/
+		void merge(vk::PipelineCache workerCache);
+
+		/**
+			Write the cache to its file. The data goes to a temporary file
+			first, which then replaces the old one, so a crash never leaves
+			a partly written cache behind.
+		*/
+		void save();
+
+		vk::PipelineCache cache;
+
+	private:
+
+		vk::Device logicalDevice;
+		vk::PhysicalDeviceProperties properties;
+		std::string filename;
+
+		//merging and reading the cache's data need it to be externally synchronized
+		std::mutex mutex;
+
+		/**
+			\param data the contents of a cache file
+			\returns whether the data was written by a cache for this device
+		*/
+		bool is_compatible(const std::vector<char>& data);
+	};
+}
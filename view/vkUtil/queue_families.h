@@ -4,11 +4,13 @@
 namespace vkUtil {
 
 	/**
-		Holds the indices of the graphics and presentation queue families.
+		Holds the indices of the graphics, presentation and transfer queue families.
 	*/
 	struct QueueFamilyIndices {
 		std::optional<uint32_t> graphicsFamily;
 		std::optional<uint32_t> presentFamily;
+		//same as the graphics family unless the device has a transfer-only family
+		std::optional<uint32_t> transferFamily;
 
 		bool isComplete() {
 			return graphicsFamily.has_value() && presentFamily.has_value();
@@ -67,7 +69,7 @@ namespace vkUtil {
 				} VkQueueFlagBits;
 			*/
 
-			if (queueFamily.queueFlags & vk::QueueFlagBits::eGraphics) {
+			if (!indices.graphicsFamily.has_value() && queueFamily.queueFlags & vk::QueueFlagBits::eGraphics) {
 				indices.graphicsFamily = i;
 
 				message << "Queue Family " << i << " is suitable for graphics.";
@@ -75,7 +77,7 @@ namespace vkUtil {
 				message.str("");
 			}
 
-			if (device.getSurfaceSupportKHR(i, surface)) {
+			if (!indices.presentFamily.has_value() && device.getSurfaceSupportKHR(i, surface)) {
 				indices.presentFamily = i;
 
 				message << "Queue Family " << i << " is suitable for presenting.";
@@ -83,13 +85,27 @@ namespace vkUtil {
 				message.str("");
 			}
 
-			if (indices.isComplete()) {
-				break;
+			/*
+			* A family which can transfer but not draw is usually backed by a
+			* DMA engine, uploads submitted there can overlap rendering.
+			*/
+			if (!indices.transferFamily.has_value()
+				&& queueFamily.queueFlags & vk::QueueFlagBits::eTransfer
+				&& !(queueFamily.queueFlags & vk::QueueFlagBits::eGraphics)) {
+				indices.transferFamily = i;
+
+				message << "Queue Family " << i << " is a dedicated transfer family.";
+				vkLogging::Logger::get_logger()->print(message.str());
+				message.str("");
 			}
 
 			i++;
 		}
 
+		if (!indices.transferFamily.has_value()) {
+			indices.transferFamily = indices.graphicsFamily;
+		}
+
 		return indices;
 	}
 }
\ No newline at end of file
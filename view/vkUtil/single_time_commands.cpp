@@ -1,21 +0,0 @@
-#include "single_time_commands.h"
-
-void vkUtil::start_job(vk::CommandBuffer commandBuffer)
-{
-	commandBuffer.reset();
-
-	vk::CommandBufferBeginInfo beginInfo;
-	beginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
-	commandBuffer.begin(beginInfo);
-}
-
-void vkUtil::end_job(vk::CommandBuffer commandBuffer, vk::Queue queue)
-{
-	commandBuffer.end();
-
-	vk::SubmitInfo submitInfo;
-	submitInfo.commandBufferCount = 1;
-	submitInfo.pCommandBuffers = &commandBuffer;
-	queue.submit(1, &submitInfo, nullptr);
-	queue.waitIdle();
-}
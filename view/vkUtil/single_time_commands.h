@@ -1,8 +0,0 @@
-#pragma once
-
-#include "../../config.h"
-
-namespace vkUtil {
-	void start_job(vk::CommandBuffer commandBuffer);
-	void end_job(vk::CommandBuffer commandBuffer, vk::Queue queue);
-}
\ No newline at end of file
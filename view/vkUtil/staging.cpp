@@ -0,0 +1,88 @@
+#include "staging.h"
+#include "../../control/logging.h"
+
+vkUtil::StagingRing::StagingRing(vk::Device logicalDevice, vk::PhysicalDevice physicalDevice, MemoryAllocator* allocator, vk::DeviceSize capacity)
+	: capacity{ capacity }, logicalDevice{ logicalDevice }, allocator{ allocator }
+{
+	BufferInputChunk input;
+	input.logicalDevice = logicalDevice;
+	input.physicalDevice = physicalDevice;
+	input.allocator = allocator;
+	input.size = capacity;
+	input.usage = vk::BufferUsageFlagBits::eTransferSrc;
+	input.memoryProperties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+	buffer = createBuffer(input);
+
+	head = 0;
+	tail = 0;
+	openRegions = false;
+}
+
+vkUtil::StagingRing::~StagingRing()
+{
+	destroyBuffer(logicalDevice, allocator, buffer);
+}
+
+bool vkUtil::StagingRing::allocate(vk::DeviceSize size, vk::DeviceSize alignment, StagingRegion& region)
+{
+	vk::DeviceSize offset = (head + alignment - 1) / alignment * alignment;
+
+	if (pending.empty() && !openRegions) {
+		head = 0;
+		tail = 0;
+		offset = 0;
+		if (size > capacity) {
+			return false;
+		}
+	}
+	//free space is [head, capacity) followed by [0, tail)
+	else if (head >= tail) {
+		if (offset + size > capacity) {
+			if (size >= tail) {
+				return false;
+			}
+			offset = 0;
+		}
+	}
+	//free space is [head, tail)
+	else if (offset + size >= tail) {
+		return false;
+	}
+
+	head = offset + size;
+	openRegions = true;
+
+	region.buffer = buffer.buffer;
+	region.offset = offset;
+	region.size = size;
+	region.data = static_cast<char*>(buffer.bufferMemory.mappedData) + offset;
+	return true;
+}
+
+void vkUtil::StagingRing::retire(uint64_t ticket)
+{
+	if (!openRegions) {
+		return;
+	}
+
+	pending.push_back({ ticket, head });
+	openRegions = false;
+}
+
+void vkUtil::StagingRing::reclaim(uint64_t completedTicket)
+{
+	while (!pending.empty() && pending.front().ticket <= completedTicket) {
+		tail = pending.front().end;
+		pending.pop_front();
+	}
+}
+
+uint64_t vkUtil::StagingRing::oldest_pending()
+{
+	return pending.empty() ? 0 : pending.front().ticket;
+}
+
+bool vkUtil::StagingRing::has_open_regions()
+{
+	return openRegions;
+}
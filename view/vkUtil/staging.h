@@ -0,0 +1,94 @@
+#pragma once
+#include "../../config.h"
+#include "memory.h"
+#include <deque>
+
+namespace vkUtil {
+
+	/**
+		A range of the staging ring which can be written to
+		and then copied from.
+	*/
+	struct StagingRegion {
+		vk::Buffer buffer;
+		vk::DeviceSize offset;
+		vk::DeviceSize size;
+		void* data;
+	};
+
+	/**
+		One persistently mapped, host visible buffer which every upload
+		stages its data through. Regions are handed out in order, and become
+		reusable once the transfer ticket of the submission which read them
+		has completed.
+	*/
+	class StagingRing {
+	public:
+
+		/**
+			Make a staging ring.
+
+			\param logicalDevice the logical device
+			\param physicalDevice the physical device
+			\param allocator the allocator which will back the ring
+			\param capacity the size (in bytes) of the ring
+		*/
+		StagingRing(vk::Device logicalDevice, vk::PhysicalDevice physicalDevice,
+			MemoryAllocator* allocator, vk::DeviceSize capacity);
+
+		~StagingRing();
+
+		/**
+			Try to reserve a region of the ring.
+
+			\param size the size (in bytes) of the region
+			\param alignment required alignment of the region's offset
+			\param region populated with the reserved region on success
+			\returns whether there was room for the region
+		*/
+		bool allocate(vk::DeviceSize size, vk::DeviceSize alignment, StagingRegion& region);
+
+		/**
+			Close off every region handed out since the last call.
+
+			\param ticket the transfer ticket of the submission reading those regions
+		*/
+		void retire(uint64_t ticket);
+
+		/**
+			Release every region whose submission has completed.
+
+			\param completedTicket the latest transfer ticket known to have completed
+		*/
+		void reclaim(uint64_t completedTicket);
+
+		/**
+			\returns the ticket guarding the oldest regions still in use, 0 if there are none
+		*/
+		uint64_t oldest_pending();
+
+		/**
+			\returns whether regions have been handed out since the last retire
+		*/
+		bool has_open_regions();
+
+		vk::DeviceSize capacity;
+
+	private:
+
+		struct PendingRange {
+			uint64_t ticket;
+			vk::DeviceSize end;
+		};
+
+		vk::Device logicalDevice;
+		MemoryAllocator* allocator;
+		Buffer buffer;
+
+		//next byte to hand out and oldest byte still being read
+		vk::DeviceSize head, tail;
+		bool openRegions;
+
+		std::deque<PendingRange> pending;
+	};
+}
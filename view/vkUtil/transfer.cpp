@@ -0,0 +1,370 @@
+#include "transfer.h"
+#include "../../control/logging.h"
+#include <algorithm>
+
+vkUtil::TransferContext::TransferContext(vk::Device logicalDevice, vk::Queue queue, vk::CommandPool commandPool, 
+	uint32_t transferFamily, uint32_t graphicsFamily, StagingRing* stagingRing)
+	: logicalDevice{ logicalDevice }, queue{ queue }, commandPool{ commandPool }, 
+	transferFamily{ transferFamily }, graphicsFamily{ graphicsFamily }, stagingRing{ stagingRing }
+{
+	vk::SemaphoreTypeCreateInfo typeInfo;
+	typeInfo.semaphoreType = vk::SemaphoreType::eTimeline;
+	typeInfo.initialValue = 0;
+	vk::SemaphoreCreateInfo semaphoreInfo;
+	semaphoreInfo.pNext = &typeInfo;
+	timeline = logicalDevice.createSemaphore(semaphoreInfo);
+
+	lastSubmitted = 0;
+	lastCompleted = 0;
+	recording = false;
+}
+
+vkUtil::TransferContext::~TransferContext()
+{
+	if (recording) {
+		current.commandBuffer.end();
+		spareBatches.push_back(current);
+	}
+
+	wait(lastSubmitted);
+
+	for (Batch& batch : spareBatches) {
+		logicalDevice.freeCommandBuffers(commandPool, batch.commandBuffer);
+	}
+
+	//the engine waits for the device to go idle before destroying the context
+	logicalDevice.destroySemaphore(timeline);
+}
+
+vkUtil::StagingRegion vkUtil::TransferContext::stage(vk::DeviceSize size, vk::DeviceSize alignment)
+{
+	if (size > stagingRing->capacity) {
+		std::stringstream message;
+		message << "Upload of " << size << " bytes doesn't fit in the " << stagingRing->capacity << " byte staging ring";
+		vkLogging::Logger::get_logger()->print(message.str());
+		throw std::runtime_error("staging ring too small");
+	}
+
+	poll();
+
+	StagingRegion region;
+	while (!stagingRing->allocate(size, alignment, region)) {
+
+		//regions which haven't been submitted yet can only be freed by submitting them
+		if (stagingRing->oldest_pending() == 0) {
+			submit();
+		}
+
+		//staged regions whose copies were never recorded can't be submitted, so nothing would free them
+		if (stagingRing->oldest_pending() == 0) {
+			std::stringstream message;
+			message << "No room for " << size << " bytes, the staging ring is full of uploads which haven't been recorded";
+			vkLogging::Logger::get_logger()->print(message.str());
+			throw std::runtime_error("staging ring full");
+		}
+		wait(stagingRing->oldest_pending());
+	}
+
+	return region;
+}
+
+std::vector<vkUtil::StagingRegion> vkUtil::TransferContext::stage_all(const std::vector<vk::DeviceSize>& sizes, vk::DeviceSize alignment)
+{
+	vk::DeviceSize total = 0;
+	for (vk::DeviceSize size : sizes) {
+		total += (size + alignment - 1) / alignment * alignment;
+	}
+	if (total > stagingRing->capacity) {
+		std::stringstream message;
+		message << "Uploads of " << total << " bytes don't fit in the " << stagingRing->capacity << " byte staging ring";
+		vkLogging::Logger::get_logger()->print(message.str());
+		throw std::runtime_error("staging ring too small");
+	}
+
+	/*
+	* Making room the way stage does would submit the regions handed
+	* out so far before they've been written, so empty the ring instead.
+	*/
+	poll();
+	if (stagingRing->has_open_regions() || stagingRing->oldest_pending() != 0) {
+		submit();
+		wait(lastSubmitted);
+	}
+
+	/*
+	* Regions from this call mustn't be submitted before they're written,
+	* so the only way to make room is to wait for uploads already submitted.
+	*/
+	std::vector<StagingRegion> regions(sizes.size());
+	for (size_t i = 0; i < sizes.size(); ++i) {
+		while (!stagingRing->allocate(sizes[i], alignment, regions[i])) {
+			if (stagingRing->oldest_pending() == 0) {
+				std::stringstream message;
+				message << "No room for " << sizes.size() << " uploads, the staging ring is held by uploads which haven't been recorded";
+				vkLogging::Logger::get_logger()->print(message.str());
+				throw std::runtime_error("staging ring full");
+			}
+			wait(stagingRing->oldest_pending());
+		}
+	}
+	return regions;
+}
+
+vk::CommandBuffer vkUtil::TransferContext::record()
+{
+	if (recording) {
+		return current.commandBuffer;
+	}
+
+	poll();
+
+	if (spareBatches.empty()) {
+
+		vk::CommandBufferAllocateInfo allocInfo = {};
+		allocInfo.commandPool = commandPool;
+		allocInfo.level = vk::CommandBufferLevel::ePrimary;
+		allocInfo.commandBufferCount = 1;
+		current.commandBuffer = logicalDevice.allocateCommandBuffers(allocInfo)[0];
+	}
+	else {
+		current = spareBatches.back();
+		spareBatches.pop_back();
+		current.commandBuffer.reset();
+	}
+
+	vk::CommandBufferBeginInfo beginInfo;
+	beginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+	current.commandBuffer.begin(beginInfo);
+	recording = true;
+
+	return current.commandBuffer;
+}
+
+void vkUtil::TransferContext::upload_buffer(const StagingRegion& srcRegion, vk::Buffer dstBuffer, vk::PipelineStageFlags dstStage, vk::AccessFlags dstAccess)
+{
+	vk::CommandBuffer commandBuffer = record();
+
+	vk::BufferCopy copyRegion;
+	copyRegion.srcOffset = srcRegion.offset;
+	copyRegion.dstOffset = 0;
+	copyRegion.size = srcRegion.size;
+	commandBuffer.copyBuffer(srcRegion.buffer, dstBuffer, 1, &copyRegion);
+
+	vk::BufferMemoryBarrier barrier;
+	barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+	barrier.dstAccessMask = dstAccess;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.buffer = dstBuffer;
+	barrier.offset = 0;
+	barrier.size = srcRegion.size;
+
+	if (!transfers_ownership()) {
+		commandBuffer.pipelineBarrier(
+			vk::PipelineStageFlagBits::eTransfer, dstStage, vk::DependencyFlags(), nullptr, barrier, nullptr
+		);
+		return;
+	}
+
+	/*
+	* Release here, the graphics queue performs the matching acquire.
+	* dstStage may not exist on this queue, so the release only
+	* makes the writes available.
+	*/
+	barrier.srcQueueFamilyIndex = transferFamily;
+	barrier.dstQueueFamilyIndex = graphicsFamily;
+	barrier.dstAccessMask = vk::AccessFlags();
+	commandBuffer.pipelineBarrier(
+		vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe,
+		vk::DependencyFlags(), nullptr, barrier, nullptr
+	);
+
+	barrier.srcAccessMask = vk::AccessFlags();
+	barrier.dstAccessMask = dstAccess;
+	currentHandoff.bufferBarriers.push_back(barrier);
+	currentHandoff.dstStages |= dstStage;
+}
+
+void vkUtil::TransferContext::release_image(vk::Image image, const vk::ImageSubresourceRange& range, 
+	vk::ImageLayout oldLayout, vk::ImageLayout newLayout, vk::PipelineStageFlags dstStage, vk::AccessFlags dstAccess)
+{
+	vk::CommandBuffer commandBuffer = record();
+
+	vk::ImageMemoryBarrier barrier;
+	barrier.oldLayout = oldLayout;
+	barrier.newLayout = newLayout;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+	barrier.subresourceRange = range;
+	barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+	barrier.dstAccessMask = dstAccess;
+
+	if (!transfers_ownership()) {
+		commandBuffer.pipelineBarrier(
+			vk::PipelineStageFlagBits::eTransfer, dstStage, vk::DependencyFlags(), nullptr, nullptr, barrier
+		);
+		return;
+	}
+
+	//the layout transition happens once, between the release and the acquire
+	barrier.srcQueueFamilyIndex = transferFamily;
+	barrier.dstQueueFamilyIndex = graphicsFamily;
+	barrier.dstAccessMask = vk::AccessFlags();
+	commandBuffer.pipelineBarrier(
+		vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe,
+		vk::DependencyFlags(), nullptr, nullptr, barrier
+	);
+
+	barrier.srcAccessMask = vk::AccessFlags();
+	barrier.dstAccessMask = dstAccess;
+	currentHandoff.imageBarriers.push_back(barrier);
+	currentHandoff.dstStages |= dstStage;
+}
+
+void vkUtil::TransferContext::finish_image(vk::Image image, const vk::ImageSubresourceRange& range,
+	vk::ImageLayout layout, std::function<void(vk::CommandBuffer)> graphicsWork)
+{
+	vk::CommandBuffer commandBuffer = record();
+
+	vk::ImageMemoryBarrier barrier;
+	barrier.oldLayout = layout;
+	barrier.newLayout = layout;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+	barrier.subresourceRange = range;
+	barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+	barrier.dstAccessMask = vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eTransferWrite;
+
+	//uploads fall back to the graphics family when there's no dedicated one
+	if (!transfers_ownership()) {
+		commandBuffer.pipelineBarrier(
+			vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer,
+			vk::DependencyFlags(), nullptr, nullptr, barrier
+		);
+		graphicsWork(commandBuffer);
+		return;
+	}
+
+	barrier.srcQueueFamilyIndex = transferFamily;
+	barrier.dstQueueFamilyIndex = graphicsFamily;
+	barrier.dstAccessMask = vk::AccessFlags();
+	commandBuffer.pipelineBarrier(
+		vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe,
+		vk::DependencyFlags(), nullptr, nullptr, barrier
+	);
+
+	barrier.srcAccessMask = vk::AccessFlags();
+	barrier.dstAccessMask = vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eTransferWrite;
+	currentHandoff.imageBarriers.push_back(barrier);
+	currentHandoff.dstStages |= vk::PipelineStageFlagBits::eTransfer;
+	currentHandoff.graphicsWork.push_back(std::move(graphicsWork));
+}
+
+uint64_t vkUtil::TransferContext::submit()
+{
+	if (!recording) {
+		return lastSubmitted;
+	}
+
+	current.commandBuffer.end();
+	current.ticket = ++lastSubmitted;
+
+	vk::TimelineSemaphoreSubmitInfo timelineInfo;
+	timelineInfo.signalSemaphoreValueCount = 1;
+	timelineInfo.pSignalSemaphoreValues = &current.ticket;
+
+	vk::SubmitInfo submitInfo;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &current.commandBuffer;
+	submitInfo.signalSemaphoreCount = 1;
+	submitInfo.pSignalSemaphores = &timeline;
+	submitInfo.pNext = &timelineInfo;
+
+	queue.submit(1, &submitInfo, nullptr);
+
+	bool handoff = !currentHandoff.bufferBarriers.empty() || !currentHandoff.imageBarriers.empty();
+	if (handoff) {
+		currentHandoff.ticket = current.ticket;
+		submittedHandoffs.push_back(std::move(currentHandoff));
+		currentHandoff = Handoff{};
+	}
+
+	stagingRing->retire(current.ticket);
+	inFlight.push_back(current);
+	recording = false;
+
+	return current.ticket;
+}
+
+bool vkUtil::TransferContext::is_complete(uint64_t ticket)
+{
+	poll();
+	return ticket <= lastCompleted;
+}
+
+void vkUtil::TransferContext::wait(uint64_t ticket)
+{
+	//tickets which were never submitted would never be signalled
+	ticket = std::min(ticket, lastSubmitted);
+	if (lastCompleted >= ticket) {
+		return;
+	}
+
+	vk::SemaphoreWaitInfo waitInfo;
+	waitInfo.semaphoreCount = 1;
+	waitInfo.pSemaphores = &timeline;
+	waitInfo.pValues = &ticket;
+	logicalDevice.waitSemaphores(waitInfo, UINT64_MAX);
+	poll();
+}
+
+void vkUtil::TransferContext::acquire(vk::CommandBuffer commandBuffer, std::vector<vk::Semaphore>& waitSemaphores,
+	std::vector<uint64_t>& waitValues, std::vector<vk::PipelineStageFlags>& waitStages)
+{
+	poll();
+
+	if (submittedHandoffs.empty()) {
+		return;
+	}
+
+	//one wait for the latest ticket covers every earlier submission too
+	waitSemaphores.push_back(timeline);
+	waitValues.push_back(submittedHandoffs.back().ticket);
+	//a wait's stage mask may not be empty, the handoffs add the stages which actually use the uploads
+	waitStages.push_back(vk::PipelineStageFlagBits::eTopOfPipe);
+
+	while (!submittedHandoffs.empty()) {
+
+		Handoff& handoff = submittedHandoffs.front();
+
+		//the semaphore wait is what orders the acquire after the release
+		commandBuffer.pipelineBarrier(
+			handoff.dstStages, handoff.dstStages, vk::DependencyFlags(),
+			nullptr, handoff.bufferBarriers, handoff.imageBarriers
+		);
+		for (const std::function<void(vk::CommandBuffer)>& work : handoff.graphicsWork) {
+			work(commandBuffer);
+		}
+		waitStages.back() |= handoff.dstStages;
+		submittedHandoffs.pop_front();
+	}
+}
+
+bool vkUtil::TransferContext::transfers_ownership()
+{
+	return transferFamily != graphicsFamily;
+}
+
+void vkUtil::TransferContext::poll()
+{
+	lastCompleted = logicalDevice.getSemaphoreCounterValue(timeline);
+
+	while (!inFlight.empty() && inFlight.front().ticket <= lastCompleted) {
+		spareBatches.push_back(inFlight.front());
+		inFlight.pop_front();
+	}
+
+	stagingRing->reclaim(lastCompleted);
+}
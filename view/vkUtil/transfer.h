@@ -0,0 +1,193 @@
+#pragma once
+#include "../../config.h"
+#include "staging.h"
+#include <functional>
+
+namespace vkUtil {
+
+	/**
+		Records uploads (copies and layout transitions) for many assets
+		into one command buffer and submits them together.
+
+		Every submission is identified by a ticket, the value it signals
+		on the context's timeline semaphore. Tickets increase monotonically
+		so completing ticket N implies all earlier ones have completed too.
+
+		The timeline is the context's own rather than the engine's frame timeline.
+		Uploads are submitted to their own queue while frames are submitted to the
+		graphics queue, and nothing orders the two. A signal on a timeline must be
+		greater than its value when it executes, so signals from both queues on one
+		timeline could run out of order and be invalid. The frame timeline's values
+		are also frame numbers, which uploads would break.
+
+		When uploads run on a different queue family than rendering, each
+		submission releases its resources to the graphics family, the graphics
+		queue then waits for its ticket and records the matching acquire
+		barriers (see acquire).
+	*/
+	class TransferContext {
+	public:
+
+		/**
+			Make a transfer context.
+
+			\param logicalDevice the logical device
+			\param queue the queue on which uploads are submitted
+			\param commandPool the pool from which to allocate command buffers,
+				created on the queue's family
+			\param transferFamily the family of the upload queue
+			\param graphicsFamily the family of the queue which will use the uploads
+			\param stagingRing the ring through which all uploads are staged
+		*/
+		TransferContext(vk::Device logicalDevice, vk::Queue queue,
+			vk::CommandPool commandPool, uint32_t transferFamily, uint32_t graphicsFamily,
+			StagingRing* stagingRing);
+
+		~TransferContext();
+
+		/**
+			Reserve staging memory, if the ring is full earlier
+			uploads are submitted and waited on as needed.
+
+			\param size the size (in bytes) to reserve
+			\param alignment required alignment of the region's offset
+			\returns the reserved region, ready to be written to
+		*/
+		StagingRegion stage(vk::DeviceSize size, vk::DeviceSize alignment = 16);
+
+		/**
+			Reserve several staging regions at once, so they can be written
+			in any order (even from other threads) before their copies are
+			recorded. Nothing else may be staged until they have been.
+			If the ring isn't empty, earlier uploads are submitted and waited on first.
+
+			\param sizes the size (in bytes) of each region
+			\param alignment required alignment of each region's offset
+			\returns the reserved regions, in the order of sizes
+		*/
+		std::vector<StagingRegion> stage_all(const std::vector<vk::DeviceSize>& sizes, vk::DeviceSize alignment = 16);
+
+		/**
+			\returns the command buffer currently recording uploads,
+				beginning a new one if needed
+		*/
+		vk::CommandBuffer record();
+
+		/**
+			Copy a staged region into a buffer and make the result
+			visible to the given stages.
+
+			\param srcRegion the staging region to copy from
+			\param dstBuffer the buffer to copy to
+			\param dstStage the pipeline stages which will consume the buffer
+			\param dstAccess the kind of access those stages will make
+		*/
+		void upload_buffer(const StagingRegion& srcRegion, vk::Buffer dstBuffer,
+			vk::PipelineStageFlags dstStage, vk::AccessFlags dstAccess);
+
+		/**
+			Finish an image upload, moving it to its final layout and
+			making it visible to the given stages of the graphics queue.
+
+			\param image the image which was written by transfer commands
+			\param range the subresources which were written
+			\param oldLayout the layout the image was written in
+			\param newLayout the layout the graphics queue will use the image in
+			\param dstStage the pipeline stages which will consume the image
+			\param dstAccess the kind of access those stages will make
+		*/
+		void release_image(vk::Image image, const vk::ImageSubresourceRange& range,
+			vk::ImageLayout oldLayout, vk::ImageLayout newLayout,
+			vk::PipelineStageFlags dstStage, vk::AccessFlags dstAccess);
+
+		/**
+			Finish an image upload with commands only a graphics queue can run,
+			like blits. They're recorded right after the upload if the upload
+			queue can run them, otherwise the image is released as it is and
+			they're recorded once the graphics queue has acquired it.
+
+			\param image the image which was written by transfer commands
+			\param range the subresources which were written
+			\param layout the layout the image was written in, the commands start from it
+			\param graphicsWork records the commands, which must leave the image
+				ready for the stages that will use it
+		*/
+		void finish_image(vk::Image image, const vk::ImageSubresourceRange& range,
+			vk::ImageLayout layout, std::function<void(vk::CommandBuffer)> graphicsWork);
+
+		/**
+			Submit everything recorded so far.
+
+			\returns the ticket identifying the submission
+		*/
+		uint64_t submit();
+
+		/**
+			\param ticket a ticket returned by submit
+			\returns whether the submission has finished on the GPU
+		*/
+		bool is_complete(uint64_t ticket);
+
+		/**
+			Block until a submission has finished on the GPU.
+
+			\param ticket a ticket returned by submit
+		*/
+		void wait(uint64_t ticket);
+
+		/**
+			Take ownership of everything uploaded by submissions so far.
+			Must be recorded before the uploaded resources are used, and the
+			returned semaphore waits made by the submission of commandBuffer.
+
+			\param commandBuffer a graphics command buffer being recorded
+			\param waitSemaphores the timeline semaphore is appended here if there was anything to acquire
+			\param waitValues the value to wait for is appended here
+			\param waitStages the stages to wait at are appended here
+		*/
+		void acquire(vk::CommandBuffer commandBuffer, std::vector<vk::Semaphore>& waitSemaphores,
+			std::vector<uint64_t>& waitValues, std::vector<vk::PipelineStageFlags>& waitStages);
+
+	private:
+
+		struct Batch {
+			vk::CommandBuffer commandBuffer;
+			uint64_t ticket;
+		};
+
+		/**
+			The acquire side of one submission's ownership transfers.
+		*/
+		struct Handoff {
+			uint64_t ticket;
+			vk::PipelineStageFlags dstStages;
+			std::vector<vk::BufferMemoryBarrier> bufferBarriers;
+			std::vector<vk::ImageMemoryBarrier> imageBarriers;
+			//recorded after the barriers
+			std::vector<std::function<void(vk::CommandBuffer)>> graphicsWork;
+		};
+
+		vk::Device logicalDevice;
+		vk::Queue queue;
+		vk::CommandPool commandPool;
+		uint32_t transferFamily, graphicsFamily;
+		StagingRing* stagingRing;
+
+		//signalled with each submission's ticket
+		vk::Semaphore timeline;
+		uint64_t lastSubmitted, lastCompleted;
+
+		bool recording;
+		Batch current;
+		std::deque<Batch> inFlight;
+		std::vector<Batch> spareBatches;
+
+		//acquires recorded for the current batch, and submitted but not yet acquired
+		Handoff currentHandoff;
+		std::deque<Handoff> submittedHandoffs;
+
+		bool transfers_ownership();
+
+		void poll();
+	};
+}
@@ -0,0 +1,187 @@
+#include "transforms.h"
+#include "cpu_features.h"
+
+/*
+* Packing is a transpose: four arrays of a component each become one
+* record per instance. The SIMD paths load a few instances from every
+* array and shuffle lanes into records.
+*/
+
+namespace {
+
+	using PackKernel = void(*)(const vkUtil::TransformBatch&, size_t, size_t, vkUtil::InstanceRecord*);
+
+	void pack_scalar(const vkUtil::TransformBatch& batch, size_t first, size_t count, vkUtil::InstanceRecord* dst) {
+
+		for (size_t i = first; i < first + count; ++i) {
+			dst[i].positionScale = glm::vec4(batch.x[i], batch.y[i], batch.z[i], batch.scale[i]);
+			dst[i].rotation = glm::vec4(batch.qx[i], batch.qy[i], batch.qz[i], batch.qw[i]);
+		}
+	}
+
+#ifdef VKUTIL_X86
+
+	void pack_sse(const vkUtil::TransformBatch& batch, size_t first, size_t count, vkUtil::InstanceRecord* dst) {
+
+		size_t i = first;
+		size_t end = first + count;
+
+		for (; i + 4 <= end; i += 4) {
+
+			__m128 p0 = _mm_loadu_ps(batch.x + i);
+			__m128 p1 = _mm_loadu_ps(batch.y + i);
+			__m128 p2 = _mm_loadu_ps(batch.z + i);
+			__m128 p3 = _mm_loadu_ps(batch.scale + i);
+			_MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+
+			__m128 q0 = _mm_loadu_ps(batch.qx + i);
+			__m128 q1 = _mm_loadu_ps(batch.qy + i);
+			__m128 q2 = _mm_loadu_ps(batch.qz + i);
+			__m128 q3 = _mm_loadu_ps(batch.qw + i);
+			_MM_TRANSPOSE4_PS(q0, q1, q2, q3);
+
+			float* out = reinterpret_cast<float*>(dst + i);
+			_mm_storeu_ps(out + 0, p0);
+			_mm_storeu_ps(out + 4, q0);
+			_mm_storeu_ps(out + 8, p1);
+			_mm_storeu_ps(out + 12, q1);
+			_mm_storeu_ps(out + 16, p2);
+			_mm_storeu_ps(out + 20, q2);
+			_mm_storeu_ps(out + 24, p3);
+			_mm_storeu_ps(out + 28, q3);
+		}
+
+		pack_scalar(batch, i, end - i, dst);
+	}
+
+	/*
+	* Transpose within each 128 bit half, afterwards row k holds
+	* instance k in its low half and instance k + 4 in its high half.
+	*/
+	VKUTIL_TARGET_AVX inline void transpose_halves(__m256& a, __m256& b, __m256& c, __m256& d) {
+		__m256 t0 = _mm256_unpacklo_ps(a, b);
+		__m256 t1 = _mm256_unpackhi_ps(a, b);
+		__m256 t2 = _mm256_unpacklo_ps(c, d);
+		__m256 t3 = _mm256_unpackhi_ps(c, d);
+		a = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+		b = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+		c = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+		d = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+	}
+
+	VKUTIL_TARGET_AVX void pack_avx(const vkUtil::TransformBatch& batch, size_t first, size_t count, vkUtil::InstanceRecord* dst) {
+
+		size_t i = first;
+		size_t end = first + count;
+
+		for (; i + 8 <= end; i += 8) {
+
+			__m256 p[4] = {
+				_mm256_loadu_ps(batch.x + i),
+				_mm256_loadu_ps(batch.y + i),
+				_mm256_loadu_ps(batch.z + i),
+				_mm256_loadu_ps(batch.scale + i)
+			};
+			transpose_halves(p[0], p[1], p[2], p[3]);
+
+			__m256 q[4] = {
+				_mm256_loadu_ps(batch.qx + i),
+				_mm256_loadu_ps(batch.qy + i),
+				_mm256_loadu_ps(batch.qz + i),
+				_mm256_loadu_ps(batch.qw + i)
+			};
+			transpose_halves(q[0], q[1], q[2], q[3]);
+
+			//a record is 32 bytes, one half of p followed by the same half of q
+			float* out = reinterpret_cast<float*>(dst + i);
+			for (int k = 0; k < 4; ++k) {
+				_mm256_storeu_ps(out + 8 * k, _mm256_permute2f128_ps(p[k], q[k], 0x20));
+				_mm256_storeu_ps(out + 8 * (k + 4), _mm256_permute2f128_ps(p[k], q[k], 0x31));
+			}
+		}
+
+		pack_sse(batch, i, end - i, dst);
+	}
+
+#endif
+
+#ifdef VKUTIL_NEON
+
+	inline void transpose_four(float32x4_t& a, float32x4_t& b, float32x4_t& c, float32x4_t& d) {
+		float32x4x2_t ab = vtrnq_f32(a, b);
+		float32x4x2_t cd = vtrnq_f32(c, d);
+		a = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+		b = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+		c = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+		d = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+	}
+
+	void pack_neon(const vkUtil::TransformBatch& batch, size_t first, size_t count, vkUtil::InstanceRecord* dst) {
+
+		size_t i = first;
+		size_t end = first + count;
+
+		for (; i + 4 <= end; i += 4) {
+
+			float32x4_t p[4] = {
+				vld1q_f32(batch.x + i),
+				vld1q_f32(batch.y + i),
+				vld1q_f32(batch.z + i),
+				vld1q_f32(batch.scale + i)
+			};
+			transpose_four(p[0], p[1], p[2], p[3]);
+
+			float32x4_t q[4] = {
+				vld1q_f32(batch.qx + i),
+				vld1q_f32(batch.qy + i),
+				vld1q_f32(batch.qz + i),
+				vld1q_f32(batch.qw + i)
+			};
+			transpose_four(q[0], q[1], q[2], q[3]);
+
+			float* out = reinterpret_cast<float*>(dst + i);
+			for (int k = 0; k < 4; ++k) {
+				vst1q_f32(out + 8 * k, p[k]);
+				vst1q_f32(out + 8 * k + 4, q[k]);
+			}
+		}
+
+		pack_scalar(batch, i, end - i, dst);
+	}
+
+#endif
+
+	struct KernelChoice {
+		PackKernel kernel;
+		const char* name;
+	};
+
+	KernelChoice choose_kernel() {
+#if defined(VKUTIL_X86)
+		if (vkUtil::cpu_has_avx()) {
+			return { pack_avx, "AVX" };
+		}
+		//every x86 CPU able to run Vulkan has SSE2
+		return { pack_sse, "SSE" };
+#elif defined(VKUTIL_NEON)
+		return { pack_neon, "NEON" };
+#else
+		return { pack_scalar, "scalar" };
+#endif
+	}
+
+	const KernelChoice& kernel_choice() {
+		static const KernelChoice choice = choose_kernel();
+		return choice;
+	}
+}
+
+void vkUtil::pack_instance_records(const TransformBatch& batch, size_t first, size_t count, InstanceRecord* dst)
+{
+	kernel_choice().kernel(batch, first, count, dst);
+}
+
+const char* vkUtil::instance_kernel_name()
+{
+	return kernel_choice().name;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "../../config.h"
+
+namespace vkUtil {
+
+	/**
+		Instance transforms laid out as structure of arrays, one
+		array per component, so kernels can load several instances
+		with a single instruction. Rotations are unit quaternions.
+	*/
+	struct TransformBatch {
+		const float* x;
+		const float* y;
+		const float* z;
+		const float* qx;
+		const float* qy;
+		const float* qz;
+		const float* qw;
+		const float* scale;
+	};
+
+	/**
+		The transform of one instance as the vertex shader reads it,
+		half the size of a full model matrix.
+	*/
+	struct InstanceRecord {
+		//xyz: position, w: uniform scale
+		glm::vec4 positionScale;
+		//a unit quaternion (x, y, z, w)
+		glm::vec4 rotation;
+	};
+
+	/**
+		Pack instance transforms into the records read by the vertex shader.
+		Uses the widest SIMD path the CPU supports (AVX, SSE or NEON)
+		and finishes any remainder with scalar code.
+
+		\param batch the instance transforms
+		\param first index of the first instance to pack
+		\param count how many instances to pack
+		\param dst records to write, instance i goes to dst[i]
+			(may be mapped GPU memory, it's only written to)
+	*/
+	void pack_instance_records(const TransformBatch& batch, size_t first, size_t count, InstanceRecord* dst);
+
+	/**
+		\returns the name of the kernel pack_instance_records runs on this CPU
+	*/
+	const char* instance_kernel_name();
+}